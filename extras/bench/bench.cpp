@@ -0,0 +1,442 @@
+// Benchmarks de codificacion y decodificacion para la compilacion en PC. Cada resultado se
+// imprime como una linea JSON con el nombre, ns/op y bytes/op para comparar versiones:
+//
+//     bench [--quick] [--filter texto]
+//
+// --quick ejecuta pocas iteraciones (para verificar que los benchmarks funcionan) y
+// --filter ejecuta solo los benchmarks cuyo nombre contiene el texto.
+#include "MsgPackMap.h"
+#include "MsgPackIterator.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+static byte buf[16384];
+static byte input[16384]; // Mensaje que leen los benchmarks de decodificacion
+static volatile uint32_t sink; // Evita que el compilador elimine las lecturas
+static bool quick = false;
+static const char *filter = NULL;
+
+// Ejecuta body hasta acumular el tiempo minimo y reporta el tiempo por operacion. body
+// realiza opsPerCall operaciones y devuelve los bytes serializados o leidos.
+template<typename F> static void bench(const char name[], uint32_t opsPerCall, F body)
+{
+    if(filter != NULL && strstr(name,filter) == NULL)
+        return;
+    const double minTime = quick ? 0.0 : 0.2;
+    uint64_t calls = 0;
+    uint64_t bytes = 0;
+    double elapsed = 0;
+    uint64_t batch = 1;
+    body();
+    while(true)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(uint64_t i=0;i<batch;i++)
+            bytes += body();
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        calls += batch;
+        if(elapsed >= minTime)
+            break;
+        batch *= 2;
+    }
+    double ops = (double)calls*opsPerCall;
+    printf("{\"name\":\"%s\",\"ns_per_op\":%.2f,\"bytes_per_op\":%.2f,\"ops\":%.0f}\n",
+           name,elapsed*1e9/ops,bytes/ops,ops);
+    fflush(stdout);
+}
+
+// Claves k00..k99 de la forma utilizada por los benchmarks de mapas grandes
+static const char *key(uint8_t i)
+{
+    static char keys[100][4];
+    char *k = keys[i];
+    k[0] = 'k';
+    k[1] = '0' + i/10;
+    k[2] = '0' + i%10;
+    k[3] = '\0';
+    return k;
+}
+
+/*********************************************************************
+  *
+  *  Codificacion por tipo: 64 elementos por mapa (cabecera map 16
+  *  reservada para no medir el desplazamiento del buffer)
+  *
+  ********************************************************************/
+
+#define ELEMENTS 64
+
+template<typename T> static void benchInteger(const char name[], T value)
+{
+    static const MsgPackKey k("v");
+    bench(name,ELEMENTS,[&]() -> uint32_t {
+        MsgPackMap map(buf,sizeof(buf));
+        map.beginMap(ELEMENTS);
+        for(int i=0;i<ELEMENTS;i++)
+            map.addInteger(k,value);
+        map.endMap();
+        return map.getMapSize();
+    });
+}
+
+static void benchEncode()
+{
+    static const MsgPackKey k("v");
+    benchInteger("encode/uint8_fixint",(uint8_t)5);
+    benchInteger("encode/uint8",(uint8_t)200);
+    benchInteger("encode/uint16",(uint16_t)40000);
+    benchInteger("encode/uint32",(uint32_t)4000000000u);
+    benchInteger("encode/uint64",(uint64_t)40000000000000ull);
+    benchInteger("encode/int8",(int8_t)-100);
+    benchInteger("encode/int16",(int16_t)-30000);
+    benchInteger("encode/int32",(int32_t)-2000000000);
+    benchInteger("encode/int64",(int64_t)-40000000000000ll);
+
+    bench("encode/float",ELEMENTS,[&]() -> uint32_t {
+        MsgPackMap map(buf,sizeof(buf));
+        map.beginMap(ELEMENTS);
+        for(int i=0;i<ELEMENTS;i++)
+            map.addFloat(k,21.5f);
+        map.endMap();
+        return map.getMapSize();
+    });
+    bench("encode/double",ELEMENTS,[&]() -> uint32_t {
+        MsgPackMap map(buf,sizeof(buf));
+        map.beginMap(ELEMENTS);
+        for(int i=0;i<ELEMENTS;i++)
+            map.addDouble(k,21.5);
+        map.endMap();
+        return map.getMapSize();
+    });
+    bench("encode/string_8",ELEMENTS,[&]() -> uint32_t {
+        MsgPackMap map(buf,sizeof(buf));
+        map.beginMap(ELEMENTS);
+        for(int i=0;i<ELEMENTS;i++)
+            map.addString(k,"node-001");
+        map.endMap();
+        return map.getMapSize();
+    });
+    bench("encode/string_64",ELEMENTS,[&]() -> uint32_t {
+        MsgPackMap map(buf,sizeof(buf));
+        map.beginMap(ELEMENTS);
+        for(int i=0;i<ELEMENTS;i++)
+            map.addString(k,"0123456789012345678901234567890123456789012345678901234567890123");
+        map.endMap();
+        return map.getMapSize();
+    });
+    bench("encode/key_string",ELEMENTS,[&]() -> uint32_t {
+        MsgPackMap map(buf,sizeof(buf));
+        map.beginMap(ELEMENTS);
+        for(int i=0;i<ELEMENTS;i++)
+            map.addBool("enabled",true);
+        map.endMap();
+        return map.getMapSize();
+    });
+}
+
+/*********************************************************************
+  *
+  *  Arreglos de 256 elementos
+  *
+  ********************************************************************/
+
+#define ARRAY_SIZE 256
+
+// Mide la codificacion de un arreglo y la lectura del mensaje codificado en input, de
+// manera que cada benchmark de lectura es independiente de los demas (ver --filter)
+template<typename E, typename D> static void benchArray(const char encodeName[], const char decodeName[], E encode, D decode)
+{
+    bench(encodeName,ARRAY_SIZE,[&]() -> uint32_t {
+        MsgPackMap map(buf,sizeof(buf));
+        map.beginMap();
+        encode(map);
+        map.endMap();
+        return map.getMapSize();
+    });
+    MsgPackMap map(input,sizeof(input));
+    map.clearData();
+    map.beginMap();
+    encode(map);
+    map.endMap();
+    uint16_t size = map.getMapSize();
+    bench(decodeName,ARRAY_SIZE,[&]() -> uint32_t {
+        MsgPackMap reader(input,size);
+        decode(reader);
+        return size;
+    });
+}
+
+static void benchArrays()
+{
+    static float floats[ARRAY_SIZE];
+    static float out[ARRAY_SIZE];
+    static uint32_t ints[ARRAY_SIZE];
+    static uint32_t intsOut[ARRAY_SIZE];
+    for(int i=0;i<ARRAY_SIZE;i++)
+    {
+        floats[i] = 20.0f + 0.125f*(i/8);
+        ints[i] = 1700000000u + i*10;
+    }
+    static const MsgPackKey k("a");
+
+    benchArray("encode/float_array","decode/float_array",
+        [&](MsgPackMap &map) { map.addFloatArray(k,floats,ARRAY_SIZE); },
+        [&](MsgPackMap &map) { map.readFloatArray(k,out,ARRAY_SIZE); sink += out[ARRAY_SIZE-1]; });
+    benchArray("encode/float_typed_array","decode/float_typed_array",
+        [&](MsgPackMap &map) { map.addTypedArray(k,floats,ARRAY_SIZE); },
+        [&](MsgPackMap &map) { sink += map.readTypedArray(k,out,ARRAY_SIZE); });
+    benchArray("encode/float_series","decode/float_series",
+        [&](MsgPackMap &map) { map.addFloatSeries(k,floats,ARRAY_SIZE); },
+        [&](MsgPackMap &map) { sink += map.readFloatSeries(k,out,ARRAY_SIZE); });
+    benchArray("encode/uint32_array","decode/uint32_array",
+        [&](MsgPackMap &map) { map.addIntegerArray(k,ints,ARRAY_SIZE); },
+        [&](MsgPackMap &map) {
+            // Los arreglos de enteros se leen elemento por elemento con el iterador
+            MsgPackIterator it(map);
+            it.next();
+            MsgPackIterator items = it.enter();
+            uint32_t value;
+            while(items.next())
+            {
+                items.read(value);
+                sink += value;
+            }
+        });
+    benchArray("encode/uint32_typed_array","decode/uint32_typed_array",
+        [&](MsgPackMap &map) { map.addTypedArray(k,ints,ARRAY_SIZE); },
+        [&](MsgPackMap &map) { sink += map.readTypedArray(k,intsOut,ARRAY_SIZE); });
+    benchArray("encode/uint32_delta_array","decode/uint32_delta_array",
+        [&](MsgPackMap &map) { map.addDeltaArray(k,ints,ARRAY_SIZE); },
+        [&](MsgPackMap &map) { sink += map.readDeltaArray(k,intsOut,ARRAY_SIZE); });
+}
+
+/*********************************************************************
+  *
+  *  Crecimiento del mapa: con beginMap() la cabecera pasa de fix map a
+  *  map 16 al agregar el elemento 16 y el buffer se desplaza (ver
+  *  rearrageBuffer()); con beginMap(n) o setReserveHeaders() no
+  *
+  ********************************************************************/
+
+static void benchMapGrowth()
+{
+    const uint8_t sizes[] = {15, 16, 64};
+    char name[64];
+    for(uint8_t s=0;s<sizeof(sizes);s++)
+    {
+        uint8_t n = sizes[s];
+        snprintf(name,sizeof(name),"map_growth/%u_keys/begin_map",n);
+        bench(name,n,[&]() -> uint32_t {
+            MsgPackMap map(buf,sizeof(buf));
+            map.beginMap();
+            for(uint8_t i=0;i<n;i++)
+                map.addInteger(key(i),i);
+            map.endMap();
+            return map.getMapSize();
+        });
+        snprintf(name,sizeof(name),"map_growth/%u_keys/begin_map_n",n);
+        bench(name,n,[&]() -> uint32_t {
+            MsgPackMap map(buf,sizeof(buf));
+            map.beginMap(n);
+            for(uint8_t i=0;i<n;i++)
+                map.addInteger(key(i),i);
+            map.endMap();
+            return map.getMapSize();
+        });
+        snprintf(name,sizeof(name),"map_growth/%u_keys/reserve_headers",n);
+        bench(name,n,[&]() -> uint32_t {
+            MsgPackMap map(buf,sizeof(buf));
+            map.setReserveHeaders(true);
+            map.beginMap();
+            for(uint8_t i=0;i<n;i++)
+                map.addInteger(key(i),i);
+            map.endMap();
+            return map.getMapSize();
+        });
+    }
+}
+
+/*********************************************************************
+  *
+  *  Busqueda de claves (getDataPosition) segun el numero de claves:
+  *  lectura de todas las claves en orden, sin y con indice
+  *
+  ********************************************************************/
+
+static void benchLookup()
+{
+    const uint8_t sizes[] = {4, 16, 64};
+    static MsgPackIndexEntry index[64];
+    char name[64];
+    for(uint8_t s=0;s<sizeof(sizes);s++)
+    {
+        uint8_t n = sizes[s];
+        MsgPackMap map(buf,sizeof(buf));
+        map.clearData();
+        map.beginMap(n);
+        for(uint8_t i=0;i<n;i++)
+            map.addInteger(key(i),(uint16_t)(1000 + i));
+        map.endMap();
+        uint16_t size = map.getMapSize();
+
+        snprintf(name,sizeof(name),"lookup/%u_keys/scan",n);
+        bench(name,n,[&]() -> uint32_t {
+            MsgPackMap reader(buf,size);
+            for(uint8_t i=0;i<n;i++)
+                sink += reader.readUnsignedInt16(key(i));
+            return size;
+        });
+        // Lectura en el orden de escritura con el cursor de lectura
+        snprintf(name,sizeof(name),"lookup/%u_keys/scan_cursor",n);
+        bench(name,n,[&]() -> uint32_t {
+            MsgPackMap reader(buf,size);
+            reader.setReadCursor(true);
+            for(uint8_t i=0;i<n;i++)
+                sink += reader.readUnsignedInt16(key(i));
+            return size;
+        });
+        snprintf(name,sizeof(name),"lookup/%u_keys/scan_buffer_size",n);
+        bench(name,n,[&]() -> uint32_t {
+            MsgPackMap reader(buf,sizeof(buf));
+            for(uint8_t i=0;i<n;i++)
+                sink += reader.readUnsignedInt16(key(i));
+            return size;
+        });
+        // Una clave inexistente recorre el buffer completo
+        snprintf(name,sizeof(name),"lookup/%u_keys/miss",n);
+        bench(name,1,[&]() -> uint32_t {
+            MsgPackMap reader(buf,size);
+            sink += reader.isKeyAvailable("none");
+            return size;
+        });
+        snprintf(name,sizeof(name),"lookup/%u_keys/miss_buffer_size",n);
+        bench(name,1,[&]() -> uint32_t {
+            MsgPackMap reader(buf,sizeof(buf));
+            sink += reader.isKeyAvailable("none");
+            return size;
+        });
+        // El mensaje asociado con attachData() limita la busqueda a su longitud
+        snprintf(name,sizeof(name),"lookup/%u_keys/miss_attached",n);
+        bench(name,1,[&]() -> uint32_t {
+            MsgPackMap reader(buf,sizeof(buf));
+            reader.attachData(buf,size);
+            sink += reader.isKeyAvailable("none");
+            return size;
+        });
+        snprintf(name,sizeof(name),"lookup/%u_keys/index_build_and_read",n);
+        bench(name,n,[&]() -> uint32_t {
+            MsgPackMap reader(buf,size);
+            reader.buildIndex(index,64);
+            for(uint8_t i=0;i<n;i++)
+                sink += reader.readUnsignedInt16(key(i));
+            return size;
+        });
+        snprintf(name,sizeof(name),"lookup/%u_keys/iterator",n);
+        bench(name,n,[&]() -> uint32_t {
+            MsgPackMap reader(buf,size);
+            MsgPackIterator it(reader);
+            uint16_t value;
+            while(it.next())
+            {
+                it.read(value);
+                sink += value;
+            }
+            return size;
+        });
+    }
+}
+
+/*********************************************************************
+  *
+  *  Mensajes de telemetria tipicos: codificacion y lectura de todos los
+  *  campos
+  *
+  ********************************************************************/
+
+static void encodeTelemetry(MsgPackMap &map, uint32_t seq)
+{
+    float accel[3] = {0.01f, -0.02f, 9.81f};
+    float gyro[3] = {0.1f, 0.2f, -0.3f};
+    map.beginMap();
+    map.addString("id","node-017");
+    map.addInteger("seq",seq);
+    map.addInteger("ts",(uint32_t)1700000000u + seq);
+    map.addFloat("temp",21.5f);
+    map.addFloat("hum",40.25f);
+    map.addFloat("press",1013.2f);
+    map.addInteger("batt",(uint16_t)3712);
+    map.addInteger("rssi",(int8_t)-71);
+    map.beginSubMap("imu");
+    map.addFloatArray("accel",accel,3);
+    map.addFloatArray("gyro",gyro,3);
+    map.endSubMap();
+    map.addBool("ok",true);
+    map.endMap();
+}
+
+static void benchTelemetry()
+{
+    static float values[3];
+    bench("telemetry/encode",1,[&]() -> uint32_t {
+        MsgPackMap map(buf,sizeof(buf));
+        encodeTelemetry(map,42);
+        return map.getMapSize();
+    });
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    encodeTelemetry(map,42);
+    uint16_t size = map.getMapSize();
+    bench("telemetry/decode",1,[&]() -> uint32_t {
+        MsgPackMap reader(buf,size);
+        char id[16];
+        reader.readString("id",id,sizeof(id));
+        sink += reader.readUnsignedInt8("seq");
+        sink += reader.readUnsignedInt32("ts");
+        sink += reader.readFloat("temp");
+        sink += reader.readFloat("hum");
+        sink += reader.readFloat("press");
+        sink += reader.readUnsignedInt16("batt");
+        sink += reader.readInt8("rssi");
+        reader.readFloatArray("accel",values,3);
+        reader.readFloatArray("gyro",values,3);
+        sink += reader.readBool("ok");
+        return size;
+    });
+    bench("telemetry/decode_path",1,[&]() -> uint32_t {
+        MsgPackMap reader(buf,size);
+        uint32_t ts;
+        float temp;
+        uint16_t batt;
+        int8_t rssi;
+        reader.readPath("ts",ts);
+        reader.readPath("temp",temp);
+        reader.readPath("batt",batt);
+        reader.readPath("rssi",rssi);
+        sink += ts + temp + batt + rssi;
+        sink += reader.isPathAvailable("imu.gyro");
+        return size;
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    for(int i=1;i<argc;i++)
+    {
+        if(strcmp(argv[i],"--quick") == 0)
+            quick = true;
+        else if(strcmp(argv[i],"--filter") == 0 && i+1 < argc)
+            filter = argv[++i];
+        else
+        {
+            fprintf(stderr,"uso: %s [--quick] [--filter texto]\n",argv[0]);
+            return 1;
+        }
+    }
+    benchEncode();
+    benchArrays();
+    benchMapGrowth();
+    benchLookup();
+    benchTelemetry();
+    return 0;
+}
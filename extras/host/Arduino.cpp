@@ -0,0 +1,8 @@
+#include "Arduino.h"
+#include <chrono>
+
+unsigned long millis()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
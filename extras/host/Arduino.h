@@ -0,0 +1,89 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// Capa de compatibilidad minima para compilar la biblioteca en una PC (Linux, macOS)
+// sin el nucleo de Arduino. Solo implementa lo que utiliza la biblioteca: el tipo byte,
+// millis(), String, Print y Stream. No se debe incluir en compilaciones para Arduino.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+
+// Milisegundos transcurridos desde la primera llamada
+unsigned long millis();
+
+class String
+{
+    public:
+        String(const char str[] = "") : data(str != NULL ? str : "") {}
+        unsigned char reserve(unsigned int size) { data.reserve(size); return 1; }
+        unsigned int length() const { return data.size(); }
+        const char *c_str() const { return data.c_str(); }
+        char charAt(unsigned int index) const { return index < data.size() ? data[index] : 0; }
+        char operator[](unsigned int index) const { return charAt(index); }
+        unsigned char concat(const char str[], unsigned int length) { data.append(str,length); return 1; }
+        String &operator+=(char c) { data.push_back(c); return *this; }
+        String &operator+=(const char str[]) { data.append(str); return *this; }
+        bool operator==(const char str[]) const { return data == str; }
+        bool operator==(const String &str) const { return data == str.data; }
+        bool operator!=(const char str[]) const { return data != str; }
+
+    private:
+        std::string data;
+};
+
+class Print
+{
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t data) = 0;
+        virtual size_t write(const uint8_t *buffer, size_t size)
+        {
+            size_t n = 0;
+            while(n < size && write(buffer[n]))
+                n++;
+            return n;
+        }
+        virtual int availableForWrite() { return 0; }
+
+        size_t print(const char str[]) { return write((const uint8_t*)str,strlen(str)); }
+        size_t print(char c) { return write((uint8_t)c); }
+        size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n,base); }
+        size_t print(int n, int base = DEC) { return print((long)n,base); }
+        size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n,base); }
+        size_t print(long n, int base = DEC)
+        {
+            if(base == DEC)
+            {
+                char buf[24];
+                snprintf(buf,sizeof(buf),"%ld",n);
+                return print(buf);
+            }
+            return print((unsigned long)n,base);
+        }
+        size_t print(unsigned long n, int base = DEC)
+        {
+            char buf[24];
+            snprintf(buf,sizeof(buf),base == HEX ? "%lX" : "%lu",n);
+            return print(buf);
+        }
+        size_t println() { return print("\r\n"); }
+        size_t println(const char str[]) { return print(str) + println(); }
+};
+
+class Stream : public Print
+{
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+};
+
+#endif // Arduino_h
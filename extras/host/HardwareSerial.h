@@ -0,0 +1,7 @@
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+// En la compilacion para PC no existe un puerto serie: MemoryStream ocupa su lugar
+#include "Arduino.h"
+
+#endif // HardwareSerial_h
@@ -0,0 +1,140 @@
+#include "MemoryStream.h"
+
+/**
+  *  @brief Constructor del objeto.
+  *  @param buf         Arreglo donde se almacenan los bytes escritos.
+  *  @param bufSize     Tamano del arreglo.
+  *  @return none
+  */
+MemoryStream::MemoryStream(byte buf[], size_t bufSize)
+{
+    buffer = buf;
+    bufferSize = bufSize;
+}
+
+/**
+  *  @brief Agrega un byte al final del arreglo.
+  *  @param data        Byte a escribir.
+  *  @return size_t     1 si se escribio el byte, 0 si el arreglo esta lleno.
+  */
+size_t MemoryStream::write(uint8_t data)
+{
+    if(writePos >= bufferSize)
+        return 0;
+    buffer[writePos++] = data;
+    return 1;
+}
+
+/**
+  *  @brief Agrega un bloque de bytes al final del arreglo.
+  *  @param data        Bytes a escribir.
+  *  @param size        Numero de bytes.
+  *  @return size_t     Numero de bytes escritos (menor a size si el arreglo se llena).
+  */
+size_t MemoryStream::write(const uint8_t *data, size_t size)
+{
+    if(size > bufferSize - writePos)
+        size = bufferSize - writePos;
+    memcpy(buffer+writePos,data,size);
+    writePos += size;
+    return size;
+}
+
+/**
+  *  @brief Espacio disponible para escribir sin bloquear, limitado con setWriteLimit()
+  *         para simular el buffer de transmision de un puerto serie.
+  *  @return int        Numero de bytes.
+  */
+int MemoryStream::availableForWrite()
+{
+    size_t space = bufferSize - writePos;
+    if(writeLimit >= 0 && (size_t)writeLimit < space)
+        return writeLimit;
+    return space;
+}
+
+/**
+  *  @brief Numero de bytes escritos que no se han leido, limitado con setReadLimit()
+  *         para simular datos que llegan por partes.
+  *  @return int        Numero de bytes.
+  */
+int MemoryStream::available()
+{
+    size_t pending = writePos - readPos;
+    if(readLimit >= 0 && (size_t)readLimit < pending)
+        return readLimit;
+    return pending;
+}
+
+/**
+  *  @brief Lee el siguiente byte.
+  *  @return int        Byte leido, -1 si no hay bytes disponibles.
+  */
+int MemoryStream::read()
+{
+    if(available() <= 0)
+        return -1;
+    if(readLimit > 0)
+        readLimit--;
+    return buffer[readPos++];
+}
+
+/**
+  *  @brief Devuelve el siguiente byte sin leerlo.
+  *  @return int        Byte siguiente, -1 si no hay bytes disponibles.
+  */
+int MemoryStream::peek()
+{
+    if(available() <= 0)
+        return -1;
+    return buffer[readPos];
+}
+
+/**
+  *  @brief Limita el valor de availableForWrite().
+  *  @param limit       Numero de bytes, -1 para no limitar.
+  *  @return none
+  */
+void MemoryStream::setWriteLimit(int limit)
+{
+    writeLimit = limit;
+}
+
+/**
+  *  @brief Limita el numero de bytes que se pueden leer. El limite disminuye con cada
+  *         byte leido.
+  *  @param limit       Numero de bytes, -1 para no limitar.
+  *  @return none
+  */
+void MemoryStream::setReadLimit(int limit)
+{
+    readLimit = limit;
+}
+
+/**
+  *  @brief Devuelve el arreglo con los bytes escritos.
+  *  @return const byte*    Apuntador al primer byte.
+  */
+const byte *MemoryStream::data()
+{
+    return buffer;
+}
+
+/**
+  *  @brief Devuelve el numero de bytes escritos.
+  *  @return size_t     Numero de bytes.
+  */
+size_t MemoryStream::size()
+{
+    return writePos;
+}
+
+/**
+  *  @brief Descarta los bytes escritos y leidos.
+  *  @return none
+  */
+void MemoryStream::clear()
+{
+    writePos = 0;
+    readPos = 0;
+}
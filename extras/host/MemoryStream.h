@@ -0,0 +1,35 @@
+#ifndef MemoryStream_h
+#define MemoryStream_h
+
+#include "Arduino.h"
+
+// Stream respaldado por un arreglo de bytes para la compilacion en PC. Los bytes escritos
+// se agregan al final del arreglo y read() los devuelve en el mismo orden, por lo que un
+// mapa escrito con writeData() se puede leer despues con MsgPackStreamParser.
+class MemoryStream : public Stream
+{
+    public:
+        MemoryStream(byte buf[], size_t bufSize);
+
+        size_t write(uint8_t data) override;
+        size_t write(const uint8_t *data, size_t size) override;
+        int availableForWrite() override;
+        int available() override;
+        int read() override;
+        int peek() override;
+
+        void setWriteLimit(int limit);
+        void setReadLimit(int limit);
+        const byte *data();
+        size_t size();
+        void clear();
+
+    private:
+        byte *buffer;
+        size_t bufferSize;
+        size_t writePos = 0;
+        size_t readPos = 0;
+        int writeLimit = -1;    // Bytes que acepta availableForWrite(), -1 sin limite
+        int readLimit = -1;     // Bytes que reporta available(), -1 sin limite
+};
+#endif // MemoryStream_h
@@ -0,0 +1,18 @@
+#ifndef MsgPackMapTest_h
+#define MsgPackMapTest_h
+
+// Macros minimas para las pruebas en PC: cada CHECK fallido se reporta y el programa
+// termina con codigo distinto de 0 (ver TEST_RESULT)
+#include <stdio.h>
+
+static int testFailures = 0;
+
+#define CHECK(cond) \
+    do { if(!(cond)) { printf("%s:%d: CHECK(%s) fallo\n",__FILE__,__LINE__,#cond); testFailures++; } } while(0)
+
+#define RUN_TEST(test) \
+    do { int before = testFailures; test(); printf("%s %s\n",before == testFailures ? "[ OK ]" : "[FAIL]",#test); } while(0)
+
+#define TEST_RESULT() (testFailures == 0 ? 0 : 1)
+
+#endif // MsgPackMapTest_h
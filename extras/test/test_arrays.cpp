@@ -0,0 +1,334 @@
+// Pruebas de los arreglos: bytes, float, enteros, arreglos tipados y comprimidos, y
+// elementos sin clave dentro de beginArray()/endArray()
+#include "MsgPackIterator.h"
+#include "test.h"
+
+static byte buf[4096];
+
+static void testFloatArray()
+{
+    float data[20];
+    float out[20] = {0};
+    for(int i=0;i<20;i++)
+        data[i] = i*0.5f - 3;
+
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addFloatArray("f",data,20);
+    map.addFloatArray(MsgPackKey("small"),data,3);
+    map.endMap();
+    CHECK(!map.hasError());
+
+    CHECK(map.readFloatArray("f",out,20));
+    CHECK(memcmp(out,data,sizeof(data)) == 0);
+    memset(out,0,sizeof(out));
+    CHECK(map.readFloatArray(MsgPackKey("small"),out,2));
+    CHECK(out[0] == data[0] && out[1] == data[1] && out[2] == 0.0f);
+    CHECK(!map.readFloatArray("none",out,20));
+}
+
+static void testIntegerArrays()
+{
+    uint8_t u8[4] = {0,127,128,255};
+    uint16_t u16[3] = {1,256,65535};
+    uint32_t u32[3] = {1,65536,4294967295u};
+    int8_t i8[3] = {-1,-33,-128};
+    int16_t i16[3] = {-129,0,32767};
+    int32_t i32[3] = {-2147483647-1,-32769,2147483647};
+
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addIntegerArray("u8",u8,4);
+    map.addIntegerArray(MsgPackKey("u16"),u16,3);
+    map.addIntegerArray("u32",u32,3);
+    map.addIntegerArray(MsgPackKey("i8"),i8,3);
+    map.addIntegerArray("i16",i16,3);
+    map.addIntegerArray(MsgPackKey("i32"),i32,3);
+    map.endMap();
+    CHECK(!map.hasError());
+
+    // Los elementos de un arreglo de enteros se leen con el iterador
+    MsgPackIterator it(map);
+    int64_t expected[6][4] = {
+        {0,127,128,255}, {1,256,65535}, {1,65536,4294967295ll},
+        {-1,-33,-128}, {-129,0,32767}, {-2147483647ll-1,-32769,2147483647}
+    };
+    int n = 0;
+    while(it.next())
+    {
+        CHECK(it.type() == MSGPACK_TYPE_ARRAY);
+        MsgPackIterator items = it.enter();
+        int k = 0;
+        int64_t value;
+        while(items.next())
+        {
+            CHECK(items.read(value) == MSGPACK_OK && value == expected[n][k]);
+            k++;
+        }
+        CHECK(k == (n == 0 ? 4 : 3));
+        n++;
+    }
+    CHECK(n == 6 && !it.hasError());
+}
+
+static void testTypedArrays()
+{
+    uint16_t u16[300];
+    int64_t i64[3] = {-1,2,-3};
+    double f64[4] = {0.5,-1e100,3,1e-10};
+    for(int i=0;i<300;i++)
+        u16[i] = i*200;
+    uint16_t u16Out[300] = {0};
+    int64_t i64Out[3];
+    double f64Out[4];
+    uint32_t wrongType[3];
+
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addTypedArray("u16",u16,300);
+    map.addTypedArray(MsgPackKey("i64"),i64,3);
+    map.addTypedArray("f64",f64,4);
+    map.endMap();
+    CHECK(!map.hasError());
+
+    CHECK(map.readTypedArray("u16",u16Out,300) == 300);
+    CHECK(memcmp(u16,u16Out,sizeof(u16)) == 0);
+    CHECK(map.readTypedArray(MsgPackKey("i64"),i64Out,3) == 3 && i64Out[2] == -3);
+    CHECK(map.readTypedArray("f64",f64Out,4) == 4 && f64Out[1] == -1e100);
+    CHECK(map.readTypedArray("u16",u16Out,10) == 10);
+    CHECK(map.readTypedArray("u16",wrongType,3) == 0);
+    CHECK(map.readTypedArray("none",wrongType,3) == 0);
+}
+
+// Compara los elementos serializados de un arreglo tipado con su valor en big endian.
+// Con 11 elementos se convierten bloques de 16 bytes y elementos restantes
+template<typename T> static bool checkTypedArrayBytes(const T (&data)[11])
+{
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addTypedArray("w",data,11);
+    map.endMap();
+    // Clave fix str (2 bytes), ext 8 (3 bytes) y tipo de los elementos (1 byte)
+    const byte *payload = buf + 1 + 2 + 3 + 1;
+    for(int i=0;i<11;i++)
+        for(size_t j=0;j<sizeof(T);j++)
+            if(payload[i*sizeof(T)+j] != (byte)((uint64_t)data[i] >> 8*(sizeof(T)-1-j)))
+                return false;
+    T out[11];
+    return !map.hasError() && map.readTypedArray("w",out,11) == 11 && memcmp(data,out,sizeof(out)) == 0;
+}
+
+static void testTypedArrayByteOrder()
+{
+    uint16_t u16[11];
+    uint32_t u32[11];
+    uint64_t u64[11];
+    for(int i=0;i<11;i++)
+    {
+        u16[i] = 0x0102 + 0x1111*i;
+        u32[i] = 0x01020304u + 0x11111111u*i;
+        u64[i] = 0x0102030405060708ull + 0x1111111111111111ull*i;
+    }
+    CHECK(checkTypedArrayBytes(u16));
+    CHECK(checkTypedArrayBytes(u32));
+    CHECK(checkTypedArrayBytes(u64));
+}
+
+static void testDeltaArrays()
+{
+    uint32_t times[200];
+    int16_t values[5] = {-5,100,-32768,32767,0};
+    uint64_t extremes[4] = {0,18446744073709551615ull,1,18446744073709551608ull};
+    for(int i=0;i<200;i++)
+        times[i] = 1000000 + i*10;
+    uint32_t timesOut[200];
+    int16_t valuesOut[5];
+    uint64_t extremesOut[4];
+    int32_t wrongType[5];
+
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addDeltaArray("t",times,200);
+    map.addDeltaArray(MsgPackKey("v"),values,5);
+    map.addDeltaArray("x",extremes,4);
+    map.endMap();
+    CHECK(!map.hasError());
+    // Los incrementos pequenos ocupan un byte por elemento
+    CHECK(map.getMapSize() < 300);
+
+    CHECK(map.readDeltaArray("t",timesOut,200) == 200);
+    CHECK(memcmp(times,timesOut,sizeof(times)) == 0);
+    CHECK(map.readDeltaArray(MsgPackKey("v"),valuesOut,5) == 5);
+    CHECK(memcmp(values,valuesOut,sizeof(values)) == 0);
+    CHECK(map.readDeltaArray("x",extremesOut,4) == 4);
+    CHECK(memcmp(extremes,extremesOut,sizeof(extremes)) == 0);
+    CHECK(map.readDeltaArray("v",wrongType,5) == 0);
+}
+
+static void testFloatSeries()
+{
+    float samples[500];
+    float out[500];
+    for(int i=0;i<500;i++)
+        samples[i] = 21.5f + 0.25f*(i/20);
+
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addFloatSeries("temp",samples,500);
+    map.addFloatSeries(MsgPackKey("one"),samples,1);
+    map.endMap();
+    CHECK(!map.hasError());
+    CHECK(map.getMapSize() < 500);
+
+    CHECK(map.readFloatSeries("temp",out,500) == 500);
+    CHECK(memcmp(samples,out,sizeof(samples)) == 0);
+    CHECK(map.readFloatSeries(MsgPackKey("one"),out,10) == 1 && out[0] == samples[0]);
+    CHECK(map.readFloatSeries("none",out,10) == 0);
+}
+
+static void testKeylessElements()
+{
+    uint8_t u8[2] = {1,2};
+    uint16_t u16[2] = {3,4};
+    uint32_t u32[2] = {5,6};
+    int8_t i8[2] = {-1,-2};
+    int16_t i16[2] = {-3,-4};
+    int32_t i32[2] = {-5,-6};
+    float f[2] = {0.5f,1.5f};
+    byte bin[3] = {9,8,7};
+
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.beginArray("a");
+    map.addInteger((uint8_t)1);
+    map.addInteger((uint16_t)1000);
+    map.addInteger((uint32_t)100000);
+    map.addInteger((int8_t)-1);
+    map.addInteger((int16_t)-1000);
+    map.addInteger((int32_t)-100000);
+    map.addInteger((uint64_t)10000000000ull);
+    map.addInteger((int64_t)-10000000000ll);
+    map.addFloat(1.5f);
+    map.addDouble(2.5);
+    map.addString("s");
+    map.addBool(true);
+    map.addNull();
+    map.addByte(bin,3);
+    map.addFloatArray(f,2);
+    map.addFloatSeries(f,2);
+    map.addIntegerArray(u8,2);
+    map.addIntegerArray(u16,2);
+    map.addIntegerArray(u32,2);
+    map.addIntegerArray(i8,2);
+    map.addIntegerArray(i16,2);
+    map.addIntegerArray(i32,2);
+    map.addTypedArray(u16,2);
+    map.addDeltaArray(i32,2);
+    map.beginSubMap();
+    map.addInteger("k",(uint8_t)5);
+    map.endSubMap();
+    map.beginArray();
+    map.endArray();
+    map.endArray();
+    map.endMap();
+    CHECK(!map.hasError());
+
+    const uint8_t types[] = {
+        MSGPACK_TYPE_INTEGER, MSGPACK_TYPE_INTEGER, MSGPACK_TYPE_INTEGER, MSGPACK_TYPE_INTEGER,
+        MSGPACK_TYPE_INTEGER, MSGPACK_TYPE_INTEGER, MSGPACK_TYPE_INTEGER, MSGPACK_TYPE_INTEGER,
+        MSGPACK_TYPE_FLOAT, MSGPACK_TYPE_FLOAT, MSGPACK_TYPE_STRING, MSGPACK_TYPE_BOOL,
+        MSGPACK_TYPE_NIL, MSGPACK_TYPE_BINARY, MSGPACK_TYPE_ARRAY, MSGPACK_TYPE_EXT,
+        MSGPACK_TYPE_ARRAY, MSGPACK_TYPE_ARRAY, MSGPACK_TYPE_ARRAY, MSGPACK_TYPE_ARRAY,
+        MSGPACK_TYPE_ARRAY, MSGPACK_TYPE_ARRAY, MSGPACK_TYPE_EXT, MSGPACK_TYPE_EXT,
+        MSGPACK_TYPE_MAP, MSGPACK_TYPE_ARRAY
+    };
+    MsgPackIterator it(map);
+    CHECK(it.next() && it.type() == MSGPACK_TYPE_ARRAY && it.size() == sizeof(types));
+    MsgPackIterator items = it.enter();
+    uint8_t n = 0;
+    while(items.next())
+    {
+        CHECK(n < sizeof(types) && items.type() == types[n]);
+        n++;
+    }
+    CHECK(n == sizeof(types) && !items.hasError());
+
+    // Un elemento sin clave fuera de un arreglo o con clave dentro de uno es un error
+    map.clearData();
+    map.beginMap();
+    map.addInteger((uint8_t)1);
+    CHECK(map.hasError());
+    map.clearData();
+    map.beginMap();
+    map.beginArray("a");
+    map.addInteger("k",(uint8_t)1);
+    CHECK(map.hasError());
+}
+
+static void testEmptyArrays()
+{
+    uint8_t u8[1] = {0};
+    int32_t i32[1] = {0};
+    float f[1] = {0};
+    byte bin[1] = {0};
+
+    // Los arreglos vacios se escriben como contenedores vacios y no desplazan los pares
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addFloatArray("f",f,0);
+    map.addByte("b",bin,0);
+    map.addIntegerArray("u",u8,0);
+    map.addIntegerArray(MsgPackKey("i"),i32,0);
+    map.addInteger("n",(uint8_t)7);
+    map.endMap();
+    CHECK(!map.hasError());
+    CHECK(buf[3] == 0x90 && buf[6] == 0xc4 && buf[7] == 0x00);
+    CHECK(map.readNumElements() == 5);
+    CHECK(map.readUnsignedInt8("n") == 7);
+    MsgPackIterator it(map);
+    int n = 0;
+    while(it.next())
+        n++;
+    CHECK(n == 5 && !it.hasError());
+
+    // Sin clave, dentro de un arreglo
+    map.clearData();
+    map.beginMap();
+    map.beginArray("a");
+    map.addIntegerArray(u8,0);
+    map.addFloatArray(f,0);
+    map.addByte(bin,0);
+    map.addInteger((uint8_t)7);
+    map.endArray();
+    map.endMap();
+    CHECK(!map.hasError());
+    CHECK(buf[3] == 0x94 && buf[4] == 0x90 && buf[5] == 0x90 && buf[6] == 0xc4 && buf[7] == 0x00 && buf[8] == 0x07);
+    MsgPackIterator top(map);
+    CHECK(top.next() && top.size() == 4);
+    MsgPackIterator items = top.enter();
+    n = 0;
+    while(items.next())
+        n++;
+    CHECK(n == 4 && !items.hasError());
+}
+
+int main()
+{
+    RUN_TEST(testFloatArray);
+    RUN_TEST(testIntegerArrays);
+    RUN_TEST(testTypedArrays);
+    RUN_TEST(testTypedArrayByteOrder);
+    RUN_TEST(testDeltaArrays);
+    RUN_TEST(testFloatSeries);
+    RUN_TEST(testKeylessElements);
+    RUN_TEST(testEmptyArrays);
+    return TEST_RESULT();
+}
@@ -0,0 +1,131 @@
+// Pruebas del recorrido de la estructura con MsgPackIterator y de los lotes de muestras
+// con MsgPackBatch
+#include "MsgPackIterator.h"
+#include "MsgPackBatch.h"
+#include "test.h"
+
+static byte buf[2048];
+
+static void testIterator()
+{
+    byte bin[2] = {1,2};
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addInteger("i",(int16_t)-300);
+    map.addFloat("f",1.5f);
+    map.addString("s","abc");
+    map.addBool("b",true);
+    map.addNull("n");
+    map.addByte("bin",bin,2);
+    map.beginArray("a");
+    map.addInteger((uint8_t)1);
+    map.addInteger((uint8_t)2);
+    map.endArray();
+    map.beginSubMap("m");
+    map.addInteger("x",(uint8_t)5);
+    map.endSubMap();
+    map.endMap();
+    CHECK(!map.hasError());
+
+    const char *keys[] = {"i","f","s","b","n","bin","a","m"};
+    const uint8_t types[] = {
+        MSGPACK_TYPE_INTEGER, MSGPACK_TYPE_FLOAT, MSGPACK_TYPE_STRING, MSGPACK_TYPE_BOOL,
+        MSGPACK_TYPE_NIL, MSGPACK_TYPE_BINARY, MSGPACK_TYPE_ARRAY, MSGPACK_TYPE_MAP
+    };
+    MsgPackIterator it(map);
+    int n = 0;
+    while(it.next())
+    {
+        CHECK(it.keySize() == strlen(keys[n]) && memcmp(it.key(),keys[n],it.keySize()) == 0);
+        CHECK(it.type() == types[n]);
+        n++;
+    }
+    CHECK(n == 8 && !it.hasError());
+
+    MsgPackIterator again(map);
+    int16_t value;
+    CHECK(again.next() && again.read(value) == MSGPACK_OK && value == -300);
+    CHECK(again.next() && again.read(value) == MSGPACK_TYPE_MISMATCH);
+    CHECK(again.next() && again.size() == 3);
+    while(again.next() && again.type() != MSGPACK_TYPE_MAP);
+    MsgPackIterator sub = again.enter();
+    uint8_t x;
+    CHECK(sub.next() && sub.keySize() == 1 && sub.read(x) == MSGPACK_OK && x == 5);
+    CHECK(!sub.next() && !sub.hasError());
+
+    // Una estructura truncada se reporta como error
+    MsgPackMap truncated(buf,map.getMapSize() - 3);
+    MsgPackIterator bad(truncated);
+    while(bad.next());
+    CHECK(bad.hasError());
+}
+
+struct Row
+{
+    uint32_t time;
+    int16_t value;
+    float level;
+};
+
+static void testBatch()
+{
+    const MsgPackField fields[] = {
+        MSGPACK_FIELD(Row,time),
+        MSGPACK_FIELD(Row,value),
+        MSGPACK_FIELD(Row,level),
+    };
+    Row rows[4];
+    MsgPackMap map(buf,sizeof(buf));
+    MsgPackBatch batch(map,fields,rows);
+    batch.setFlushSize(3);
+    for(int i=0;i<3;i++)
+    {
+        Row row = {1000u + i, (int16_t)(i - 1), i*0.5f};
+        CHECK(!batch.isFlushDue());
+        CHECK(batch.addRow(&row));
+    }
+    CHECK(batch.isFlushDue());
+    CHECK(batch.getNumRows() == 3);
+
+    // Filas: un arreglo de mapas
+    map.clearData();
+    map.beginMap();
+    CHECK(batch.encode("rows"));
+    map.endMap();
+    MsgPackIterator it(map);
+    CHECK(it.next() && it.type() == MSGPACK_TYPE_ARRAY && it.size() == 3);
+    MsgPackIterator items = it.enter();
+    int n = 0;
+    while(items.next())
+    {
+        Row out;
+        MsgPackMap row(buf+items.valuePos(),items.valueSize());
+        CHECK(row.readStruct(out,fields) == 3);
+        CHECK(out.time == 1000u + n && out.value == n - 1 && out.level == n*0.5f);
+        n++;
+    }
+    CHECK(n == 3);
+
+    // Columnas: un mapa de arreglos, con la marca de tiempo comprimida
+    batch.setMode(MSGPACK_BATCH_COLUMNS);
+    batch.setDeltaEncoding(0,true);
+    map.clearData();
+    map.beginMap();
+    CHECK(batch.encode(MsgPackKey("cols")));
+    map.endMap();
+    uint32_t times[3];
+    float levels[3];
+    CHECK(map.readDeltaArray("time",times,3) == 3 && times[2] == 1002);
+    CHECK(map.readFloatArray("level",levels,3) && levels[1] == 0.5f);
+
+    batch.clear();
+    CHECK(batch.getNumRows() == 0 && !batch.isFlushDue());
+}
+
+int main()
+{
+    RUN_TEST(testIterator);
+    RUN_TEST(testBatch);
+    return TEST_RESULT();
+}
@@ -0,0 +1,266 @@
+// Pruebas de los pares add*/read* de valores simples (enteros, reales, cadenas, etc.)
+#include "MsgPackMap.h"
+#include "test.h"
+#include <math.h>
+
+static byte buf[512];
+
+// Posicion del valor de una clave corta (fix str) dentro de la estructura serializada
+static int valuePos(const char key[])
+{
+    size_t len = strlen(key);
+    for(size_t i=0;i+len+1<sizeof(buf);i++)
+    {
+        if(buf[i] == 0xa0+len && memcmp(buf+i+1,key,len) == 0)
+            return i+1+len;
+    }
+    return -1;
+}
+
+static void testUnsignedIntegers()
+{
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addInteger("u8a",(uint8_t)127);
+    map.addInteger("u8b",(uint8_t)255);
+    map.addInteger("u16",(uint16_t)65535);
+    map.addInteger("u32",(uint32_t)4294967295u);
+    map.addInteger("u64",(uint64_t)18446744073709551615ull);
+    map.addInteger(MsgPackKey("k16"),(uint16_t)300);
+    map.addInteger(MsgPackKey("k32"),(uint32_t)70000);
+    map.addInteger(MsgPackKey("k64"),(uint64_t)5000000000ull);
+    map.addInteger(MsgPackKey("k8"),(uint8_t)3);
+    map.endMap();
+    CHECK(!map.hasError());
+    CHECK(map.readNumElements() == 9);
+
+    CHECK(map.readUnsignedInt8("u8a") == 127);
+    CHECK(map.readUnsignedInt8("u8b") == 255);
+    CHECK(map.readUnsignedInt16("u16") == 65535);
+    CHECK(map.readUnsignedInt32("u32") == 4294967295u);
+    CHECK(map.readUnsignedInt64("u64") == 18446744073709551615ull);
+    CHECK(map.readUnsignedInt8(MsgPackKey("k8")) == 3);
+    CHECK(map.readUnsignedInt16(MsgPackKey("k16")) == 300);
+    CHECK(map.readUnsignedInt32(MsgPackKey("k32")) == 70000);
+    CHECK(map.readUnsignedInt64(MsgPackKey("k64")) == 5000000000ull);
+
+    // Cada valor utiliza el formato mas corto
+    CHECK(buf[valuePos("u8a")] == 127);
+    CHECK(buf[valuePos("u8b")] == 0xcc);
+    CHECK(buf[valuePos("k16")] == 0xcd);
+    CHECK(buf[valuePos("u32")] == 0xce);
+    CHECK(buf[valuePos("u64")] == 0xcf);
+    CHECK(buf[valuePos("k64")] == 0xcf);
+}
+
+static void testSignedIntegers()
+{
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addInteger("i8a",(int8_t)-32);
+    map.addInteger("i8b",(int8_t)-128);
+    map.addInteger("i16",(int16_t)-32768);
+    map.addInteger("i32",(int32_t)-2147483647-1);
+    map.addInteger("i64",(int64_t)-9223372036854775807ll-1);
+    map.addInteger(MsgPackKey("k8"),(int8_t)-100);
+    map.addInteger(MsgPackKey("k16"),(int16_t)-200);
+    map.addInteger(MsgPackKey("k32"),(int32_t)-70000);
+    map.addInteger(MsgPackKey("k64"),(int64_t)-5000000000ll);
+    map.endMap();
+    CHECK(!map.hasError());
+
+    CHECK(map.readInt8("i8a") == -32);
+    CHECK(map.readInt8("i8b") == -128);
+    CHECK(map.readInt16("i16") == -32768);
+    CHECK(map.readInt32("i32") == -2147483647-1);
+    CHECK(map.readInt64("i64") == -9223372036854775807ll-1);
+    CHECK(map.readInt8(MsgPackKey("k8")) == -100);
+    CHECK(map.readInt16(MsgPackKey("k16")) == -200);
+    CHECK(map.readInt32(MsgPackKey("k32")) == -70000);
+    CHECK(map.readInt64(MsgPackKey("k64")) == -5000000000ll);
+
+    CHECK(buf[valuePos("i8a")] == 0xe0);
+    CHECK(buf[valuePos("i8b")] == 0xd0);
+    CHECK(buf[valuePos("i16")] == 0xd1);
+    CHECK(buf[valuePos("i32")] == 0xd2);
+    CHECK(buf[valuePos("i64")] == 0xd3);
+}
+
+static void testRealNumbers()
+{
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addFloat("f",-1.25f);
+    map.addFloat(MsgPackKey("fk"),3.5e10f);
+    map.addDouble("d",3.141592653589793);
+    map.addDouble(MsgPackKey("dk"),-1e-300);
+    map.addInteger("n",(int16_t)-7);
+    map.endMap();
+    CHECK(!map.hasError());
+
+    CHECK(map.readFloat("f") == -1.25f);
+    CHECK(map.readFloat(MsgPackKey("fk")) == 3.5e10f);
+    CHECK(map.readDouble("d") == 3.141592653589793);
+    CHECK(map.readDouble(MsgPackKey("dk")) == -1e-300);
+    CHECK(buf[valuePos("f")] == 0xca);
+    CHECK(buf[valuePos("d")] == 0xcb);
+    // read*() solo acepta el formato de su tipo; read() convierte entre tipos compatibles
+    CHECK(map.readFloat("d") == 0.0f);
+    CHECK(map.readInt8("n") == -7 && map.readInt16("n") == 0);
+    float narrow;
+    int32_t wide;
+    CHECK(map.read("d",narrow) == MSGPACK_OK && fabsf(narrow - 3.1415927f) < 1e-6f);
+    CHECK(map.read("n",wide) == MSGPACK_OK && wide == -7);
+}
+
+static void testStringsAndBytes()
+{
+    char text[40];
+    char longText[300];
+    memset(longText,'x',sizeof(longText)-1);
+    longText[sizeof(longText)-1] = '\0';
+    byte data[5] = {0,1,2,254,255};
+    byte out[8] = {0};
+
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addString("s","hola");
+    map.addString(MsgPackKey("e"),"");
+    map.addString("long",longText);
+    map.addBool("t",true);
+    map.addBool(MsgPackKey("f"),false);
+    map.addNull("nil");
+    map.addNull(MsgPackKey("nk"));
+    map.addByte("bin",data,sizeof(data));
+    map.addByte(MsgPackKey("bk"),data,2);
+    map.endMap();
+    CHECK(!map.hasError());
+
+    CHECK(map.readString("s") == "hola");
+    CHECK(map.readString(MsgPackKey("e")) == "");
+    CHECK(map.readString("long").length() == 299);
+    CHECK(map.readString("s",text,sizeof(text)) == 4 && strcmp(text,"hola") == 0);
+    CHECK(map.readString(MsgPackKey("s"),text,3) == 2 && strcmp(text,"ho") == 0);
+    const char *ref;
+    uint16_t refSize;
+    CHECK(map.readStringRef("s",ref,refSize) && refSize == 4 && memcmp(ref,"hola",4) == 0);
+    CHECK(map.readStringRef(MsgPackKey("long"),ref,refSize) && refSize == 299);
+    CHECK(!map.readStringRef("t",ref,refSize));
+
+    CHECK(map.readBool("t"));
+    CHECK(!map.readBool(MsgPackKey("f")));
+    CHECK(buf[valuePos("nil")] == 0xc0);
+    CHECK(buf[valuePos("nk")] == 0xc0);
+    CHECK(map.isKeyAvailable("nil"));
+
+    CHECK(map.readByte("bin",out,sizeof(out)));
+    CHECK(memcmp(out,data,sizeof(data)) == 0);
+    memset(out,0,sizeof(out));
+    CHECK(map.readByte(MsgPackKey("bk"),out,sizeof(out)));
+    CHECK(out[0] == 0 && out[1] == 1 && out[2] == 0);
+    CHECK(!map.readByte("s",out,sizeof(out)));
+
+    // Claves de mas de 255 caracteres se escriben como str 16
+    map.clearData();
+    map.beginMap();
+    map.addInteger(longText,(uint8_t)7);
+    map.addInteger(MsgPackKey(longText,40),(uint8_t)8);
+    map.endMap();
+    CHECK(!map.hasError());
+    CHECK(buf[1] == 0xda && buf[2] == 0x01 && buf[3] == 0x2b);
+    CHECK(map.readUnsignedInt8(longText) == 7);
+    CHECK(map.readUnsignedInt8(MsgPackKey(longText,40)) == 8);
+    uint8_t value;
+    CHECK(map.readPath(longText,value) == MSGPACK_OK && value == 7);
+    CHECK(!map.isKeyAvailable(MsgPackKey(longText,298)));
+}
+
+static void testMissingKeys()
+{
+    char text[8] = "x";
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addInteger("a",(uint8_t)1);
+    map.endMap();
+
+    CHECK(!map.isKeyAvailable("b"));
+    CHECK(!map.isKeyAvailable(MsgPackKey("b")));
+    CHECK(map.readUnsignedInt32("b") == 0);
+    CHECK(map.readInt64("b") == 0);
+    CHECK(map.readFloat("b") == 0.0f);
+    CHECK(map.readString("b") == "");
+    CHECK(map.readString("b",text,sizeof(text)) == 0);
+    CHECK(!map.readBool("b"));
+}
+
+struct Sample
+{
+    uint32_t time;
+    int16_t value;
+    float level;
+    bool on;
+    char name[8];
+};
+
+static void testTemplatesAndStructs()
+{
+    const MsgPackField fields[] = {
+        MSGPACK_FIELD(Sample,time),
+        MSGPACK_FIELD(Sample,value),
+        MSGPACK_FIELD(Sample,level),
+        MSGPACK_FIELD(Sample,on),
+        MSGPACK_FIELD_KEY(Sample,name,"n"),
+    };
+    Sample in = {123456, -42, 2.5f, true, "node"};
+    Sample out;
+    memset(&out,0,sizeof(out));
+
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addStruct(in,fields);
+    map.beginSubMap("sub");
+    map.addInteger("big",(uint32_t)300);
+    map.endSubMap();
+    map.endMap();
+    CHECK(!map.hasError());
+
+    CHECK(map.readStruct(out,fields) == 5);
+    CHECK(out.time == in.time && out.value == in.value && out.level == in.level);
+    CHECK(out.on && strcmp(out.name,"node") == 0);
+    // Una cabecera cortada no se lee fuera del mensaje
+    byte cut[] = {0xdf,0x00};
+    MsgPackMap truncated(buf,sizeof(buf));
+    truncated.attachData(cut,1);
+    CHECK(truncated.readStruct(out,fields) == 0);
+    truncated.attachData(cut,0);
+    CHECK(truncated.readStruct(out,fields) == 0);
+
+    int32_t value;
+    uint8_t small;
+    double level;
+    uint16_t big;
+    CHECK(map.read("value",value) == MSGPACK_OK && value == -42);
+    CHECK(map.read(MsgPackKey("level"),level) == MSGPACK_OK && level == 2.5);
+    CHECK(map.read("value",small) == MSGPACK_TYPE_MISMATCH);
+    CHECK(map.read("missing",value) == MSGPACK_NOT_FOUND);
+    CHECK(map.readPath("sub.big",big) == MSGPACK_OK && big == 300);
+    CHECK(map.readPath("sub.big",small) == MSGPACK_TYPE_MISMATCH);
+    CHECK(map.readPath("sub.none",big) == MSGPACK_NOT_FOUND);
+}
+
+int main()
+{
+    RUN_TEST(testUnsignedIntegers);
+    RUN_TEST(testSignedIntegers);
+    RUN_TEST(testRealNumbers);
+    RUN_TEST(testStringsAndBytes);
+    RUN_TEST(testMissingKeys);
+    RUN_TEST(testTemplatesAndStructs);
+    return TEST_RESULT();
+}
@@ -0,0 +1,304 @@
+// Pruebas del envio de la estructura a un Stream y de la decodificacion incremental con
+// MsgPackStreamParser, utilizando MemoryStream en lugar de un puerto serie
+#include "MsgPackStreamParser.h"
+#include "MemoryStream.h"
+#include "test.h"
+
+static byte buf[256];
+static byte streamBuf[1024];
+
+static void buildMap(MsgPackMap &map)
+{
+    float accel[3] = {1,2,3};
+    map.clearData();
+    map.beginMap();
+    map.addFloat("t",21.5f);
+    map.beginSubMap("imu");
+    map.addInteger("n",(uint8_t)7);
+    map.beginSubMap("e");
+    map.endSubMap();
+    map.addFloatArray("acc",accel,3);
+    map.endSubMap();
+    map.addString("name","node-1");
+    map.endMap();
+}
+
+// Stream que no implementa availableForWrite(), como SoftwareSerial
+class PlainStream : public Stream
+{
+    public:
+        size_t write(uint8_t data) override { return stream.write(data); }
+        int available() override { return stream.available(); }
+        int read() override { return stream.read(); }
+        int peek() override { return stream.peek(); }
+        MemoryStream stream{streamBuf,sizeof(streamBuf)};
+};
+
+static void testWriteData()
+{
+    MemoryStream stream(streamBuf,sizeof(streamBuf));
+    MsgPackMap map(buf,sizeof(buf));
+    buildMap(map);
+    map.setStream(stream);
+    map.setWriteChunkSize(5);
+    CHECK(map.writeData() == 0);
+    CHECK(stream.size() == map.getMapSize());
+    CHECK(memcmp(stream.data(),buf,map.getMapSize()) == 0);
+
+    // Envio no bloqueante: cada llamada escribe a lo sumo lo que acepta el Stream
+    stream.clear();
+    stream.setWriteLimit(3);
+    map.setWriteChunkSize(64);
+    map.beginWriteData();
+    int calls = 0;
+    uint16_t pending = map.getMapSize();
+    while(pending > 0 && calls < 1000)
+    {
+        uint16_t left = map.continueWriteData();
+        CHECK(pending - left <= 3);
+        pending = left;
+        calls++;
+    }
+    CHECK(pending == 0);
+    CHECK(calls == (map.getMapSize() + 2)/3);
+    CHECK(memcmp(stream.data(),buf,map.getMapSize()) == 0);
+
+    // Sin espacio en el Stream no se escribe nada
+    stream.clear();
+    stream.setWriteLimit(0);
+    map.beginWriteData();
+    CHECK(map.continueWriteData() == map.getMapSize());
+    CHECK(stream.size() == 0);
+
+    // Si el Stream nunca reporta espacio se envian bloques de writeChunkSize
+    PlainStream plain;
+    map.setStream(plain);
+    map.setWriteChunkSize(8);
+    map.beginWriteData();
+    CHECK(map.continueWriteData() == map.getMapSize() - 8);
+    calls = 1;
+    while(map.continueWriteData() > 0 && calls < 1000)
+        calls++;
+    CHECK(plain.stream.size() == map.getMapSize());
+    CHECK(memcmp(plain.stream.data(),buf,map.getMapSize()) == 0);
+
+    // writeData() reporta los bytes que el Stream no acepto
+    byte shortBuf[10];
+    MemoryStream full(shortBuf,sizeof(shortBuf));
+    map.setStream(full);
+    CHECK(map.writeData() == map.getMapSize() - sizeof(shortBuf));
+}
+
+static void testPrintRawData()
+{
+    MemoryStream stream(streamBuf,sizeof(streamBuf));
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addInteger("a",(uint8_t)200);
+    map.endMap();
+    map.setStream(stream);
+    map.printRawData();
+    CHECK(stream.size() == 17);
+    CHECK(memcmp(stream.data(),"81 A1 61 CC C8 \r\n",17) == 0);
+}
+
+static int values = 0;
+static int subMaps = 0;
+static int ends = 0;
+static float temperature = 0;
+static char name[16];
+
+static void handler(const MsgPackEvent &event)
+{
+    if(event.type == MSGPACK_EVENT_VALUE)
+    {
+        values++;
+        if(strcmp(event.key,"t") == 0 || strcmp(event.key,"temperature") == 0)
+            temperature = event.pair->readFloat(event.key);
+        if(strcmp(event.key,"name") == 0)
+            event.pair->readString("name",name,sizeof(name));
+    }
+    else if(event.type == MSGPACK_EVENT_BEGIN_MAP)
+        subMaps++;
+    else if(event.type == MSGPACK_EVENT_END)
+        ends++;
+}
+
+static void testStreamParser()
+{
+    MsgPackMap map(buf,sizeof(buf));
+    buildMap(map);
+    MemoryStream stream(streamBuf,sizeof(streamBuf));
+    stream.write(buf,map.getMapSize());
+    stream.write(buf,map.getMapSize());
+
+    byte scratch[48];
+    MsgPackStreamParser parser(scratch,sizeof(scratch));
+    parser.setStream(stream);
+    parser.setHandler(handler);
+    values = subMaps = ends = 0;
+    int done = 0;
+    // Los datos llegan de tres en tres bytes
+    while(stream.available() > 0 || done < 2)
+    {
+        stream.setReadLimit(3);
+        while(parser.parse())
+            done++;
+        CHECK(!parser.hasError());
+        if(parser.hasError() || (stream.available() == 0 && stream.size() == 0))
+            break;
+        stream.setReadLimit(-1);
+        if(stream.available() == 0)
+            break;
+    }
+    CHECK(done == 2);
+    CHECK(ends == 2);
+    CHECK(values == 8);
+    CHECK(subMaps == 4);
+    CHECK(temperature == 21.5f);
+    CHECK(strcmp(name,"node-1") == 0);
+
+    // Un buffer demasiado pequeno para un valor genera un error
+    stream.clear();
+    stream.write(buf,map.getMapSize());
+    byte tiny[8];
+    MsgPackStreamParser small(tiny,sizeof(tiny));
+    small.setStream(stream);
+    small.setHandler(handler);
+    CHECK(!small.parse());
+    CHECK(small.hasError());
+    small.reset();
+    CHECK(!small.hasError());
+}
+
+static void testStreamParserLargeMap()
+{
+    char key[4] = "k00";
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    for(uint8_t i=0;i<20;i++)
+    {
+        key[1] = '0' + i/10;
+        key[2] = '0' + i%10;
+        map.addInteger(key,i);
+    }
+    map.beginSubMap("sub");
+    for(uint8_t i=0;i<18;i++)
+    {
+        key[1] = '0' + i/10;
+        key[2] = '0' + i%10;
+        map.addBool(key,true);
+    }
+    map.endSubMap();
+    map.endMap();
+    CHECK(!map.hasError());
+    MemoryStream stream(streamBuf,sizeof(streamBuf));
+    stream.write(buf,map.getMapSize());
+
+    // El buffer solo guarda el par en proceso, no todos los elementos del mapa
+    byte scratch[32];
+    MsgPackStreamParser parser(scratch,sizeof(scratch));
+    parser.setStream(stream);
+    parser.setHandler(handler);
+    values = subMaps = ends = 0;
+    CHECK(parser.parse() && !parser.hasError());
+    CHECK(values == 38 && subMaps == 1 && ends == 1);
+
+    // Un arreglo con mas elementos que el buffer no se puede almacenar
+    uint8_t items[40] = {0};
+    map.clearData();
+    map.beginMap();
+    map.addIntegerArray("a",items,40);
+    map.endMap();
+    stream.clear();
+    stream.write(buf,map.getMapSize());
+    MsgPackStreamParser small(scratch,sizeof(scratch));
+    small.setStream(stream);
+    small.setHandler(handler);
+    CHECK(!small.parse() && small.hasError());
+}
+
+static const MsgPackKey dictionary[] = {"temperature","humidity"};
+
+static void testStreamParserDictionary()
+{
+    MsgPackMap map(buf,sizeof(buf));
+    map.setKeyDictionary(dictionary);
+    map.clearData();
+    map.beginMap();
+    map.addFloat("temperature",-3.5f);
+    map.addInteger("humidity",(uint8_t)50);
+    map.endMap();
+    MemoryStream stream(streamBuf,sizeof(streamBuf));
+    stream.write(buf,map.getMapSize());
+
+    byte scratch[48];
+    MsgPackStreamParser parser(scratch,sizeof(scratch));
+    parser.setStream(stream);
+    parser.setHandler(handler);
+    parser.setKeyDictionary(dictionary,2);
+    values = 0;
+    CHECK(parser.parse());
+    CHECK(values == 2 && temperature == -3.5f);
+
+    // Sin el diccionario las claves enteras no son validas
+    stream.clear();
+    stream.write(buf,map.getMapSize());
+    MsgPackStreamParser plain(scratch,sizeof(scratch));
+    plain.setStream(stream);
+    plain.setHandler(handler);
+    CHECK(!plain.parse() && plain.hasError());
+}
+
+static void testStreamParserDepth()
+{
+    MsgPackMapT<MAX_SUBMAPS+2> map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    for(uint8_t i=0;i<MAX_SUBMAPS+2;i++)
+        map.beginSubMap("s");
+    map.addInteger("x",(uint8_t)1);
+    for(uint8_t i=0;i<MAX_SUBMAPS+2;i++)
+        map.endSubMap();
+    map.endMap();
+    CHECK(!map.hasError());
+    MemoryStream stream(streamBuf,sizeof(streamBuf));
+    stream.write(buf,map.getMapSize());
+
+    // Con los niveles por omision la estructura es demasiado profunda
+    byte scratch[32];
+    MsgPackStreamParser plain(scratch,sizeof(scratch));
+    plain.setStream(stream);
+    plain.setHandler(handler);
+    CHECK(!plain.parse() && plain.hasError());
+
+    stream.clear();
+    stream.write(buf,map.getMapSize());
+    uint32_t remaining[MAX_SUBMAPS+3];
+    MsgPackStreamParserBase parser(scratch,sizeof(scratch),remaining,MAX_SUBMAPS+2);
+    parser.setStream(stream);
+    parser.setHandler(handler);
+    values = subMaps = ends = 0;
+    CHECK(parser.parse() && !parser.hasError());
+    CHECK(values == 1 && subMaps == MAX_SUBMAPS+2 && ends == 1);
+
+    stream.clear();
+    stream.write(buf,map.getMapSize());
+    MsgPackStreamParserT<MAX_SUBMAPS+2> owned(scratch,sizeof(scratch));
+    owned.setStream(stream);
+    owned.setHandler(handler);
+    CHECK(owned.parse() && !owned.hasError());
+}
+
+int main()
+{
+    RUN_TEST(testWriteData);
+    RUN_TEST(testPrintRawData);
+    RUN_TEST(testStreamParser);
+    RUN_TEST(testStreamParserLargeMap);
+    RUN_TEST(testStreamParserDictionary);
+    RUN_TEST(testStreamParserDepth);
+    return TEST_RESULT();
+}
@@ -0,0 +1,396 @@
+// Pruebas de la estructura: submapas, cabeceras, indice de claves, rutas, limite del
+// buffer, datos invalidos, mensajes recibidos, cursor de lectura y diccionario de claves
+#include "MsgPackIterator.h"
+#include "test.h"
+
+static byte buf[2048];
+
+static void testSubMaps()
+{
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addInteger("id",(uint8_t)1);
+    map.beginSubMap("imu");
+    map.beginSubMap(MsgPackKey("accel"));
+    map.addFloat("x",1.0f);
+    map.addFloat("y",2.0f);
+    map.endSubMap();
+    map.addInteger("n",(uint8_t)2);
+    map.endSubMap();
+    map.beginSubMap("empty");
+    map.endSubMap();
+    map.addInteger("x",(uint8_t)9);
+    map.endMap();
+    CHECK(!map.hasError());
+    CHECK(map.readNumElements() == 4);
+    CHECK(buf[0] == 0x84);
+
+    // La busqueda por clave devuelve la primera aparicion, la ruta distingue el nivel
+    CHECK(map.readFloat("x") == 1.0f);
+    float x;
+    uint8_t top;
+    CHECK(map.readPath("imu.accel.x",x) == MSGPACK_OK && x == 1.0f);
+    CHECK(map.readPath("x",top) == MSGPACK_OK && top == 9);
+    CHECK(map.isPathAvailable("imu.n"));
+    CHECK(map.isPathAvailable("empty"));
+    CHECK(!map.isPathAvailable("imu.x"));
+    CHECK(!map.isPathAvailable("id.x"));
+}
+
+static void testLargeMaps()
+{
+    char key[4] = "k00";
+    MsgPackMap map(buf,sizeof(buf));
+    for(int mode=0;mode<3;mode++)
+    {
+        map.setReserveHeaders(mode == 2);
+        map.clearData();
+        if(mode == 1)
+            map.beginMap(40);
+        else
+            map.beginMap();
+        for(uint8_t i=0;i<40;i++)
+        {
+            key[1] = '0' + i/10;
+            key[2] = '0' + i%10;
+            map.addInteger(key,i);
+        }
+        map.beginSubMap("small");
+        map.addInteger("a",(uint8_t)1);
+        map.endSubMap();
+        map.endMap();
+        CHECK(!map.hasError());
+        CHECK(buf[0] == 0xde);
+        CHECK(map.readNumElements() == 41);
+        CHECK(map.readUnsignedInt8("k00") == 0);
+        CHECK(map.readUnsignedInt8("k39") == 39);
+        CHECK(map.isPathAvailable("small.a"));
+    }
+    map.setReserveHeaders(false);
+
+    // El numero de elementos de un map 32 no se trunca a 16 bits
+    byte map32[] = {0xdf,0x00,0x01,0x00,0x01};
+    map.attachData(map32,sizeof(map32));
+    CHECK(map.readNumElements() == 65537);
+}
+
+static void testIndex()
+{
+    MsgPackIndexEntry index[8];
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addInteger("a",(uint8_t)1);
+    map.beginSubMap("s");
+    map.addInteger("a",(uint8_t)2);
+    map.addInteger("b",(uint8_t)3);
+    map.endSubMap();
+    map.beginArray("arr");
+    map.beginSubMap();
+    map.addInteger("c",(uint8_t)4);
+    map.endSubMap();
+    map.endArray();
+    map.endMap();
+    CHECK(!map.hasError());
+
+    CHECK(map.buildIndex(index,8));
+    CHECK(map.readUnsignedInt8("a") == 1);
+    CHECK(map.readUnsignedInt8("b") == 3);
+    CHECK(map.readUnsignedInt8("c") == 4);
+    CHECK(!map.isKeyAvailable("d"));
+    uint8_t value;
+    CHECK(map.readPath("s.a",value) == MSGPACK_OK && value == 2);
+
+    // Las claves construidas en ejecucion calculan el hash solo al buscarlas en el indice
+    const char *runtimeKey = "arr";
+    CHECK(!MsgPackKey(runtimeKey,strlen(runtimeKey)).hashed && MsgPackKey("arr").hashed);
+    CHECK(map.isKeyAvailable(MsgPackKey(runtimeKey,strlen(runtimeKey))));
+
+    // La longitud de una clave en un arreglo llega hasta el primer '\0'
+    char name[16] = "a";
+    static const char constName[8] = "b";
+    CHECK(MsgPackKey(name).length == 1 && !MsgPackKey(name).hashed);
+    CHECK(MsgPackKey(constName).length == 1 && MsgPackKey(constName).hashed);
+    CHECK(map.readUnsignedInt8(MsgPackKey(name)) == 1);
+    CHECK(map.readUnsignedInt8(MsgPackKey(constName)) == 3);
+    map.clearIndex();
+    CHECK(map.readUnsignedInt8(MsgPackKey(name)) == 1);
+    map.clearIndex();
+    CHECK(!map.buildIndex(index,3));
+}
+
+static void testBufferLimit()
+{
+    byte small[16];
+    MsgPackMap map(small,sizeof(small));
+    map.clearData();
+    map.beginMap();
+    map.addInteger("a",(uint32_t)100000);
+    CHECK(!map.hasError());
+    map.addString("b","cadena demasiado larga");
+    CHECK(map.hasError());
+    // Los elementos posteriores al error se descartan
+    map.addInteger("c",(uint8_t)1);
+    map.endMap();
+    CHECK(map.hasError());
+    CHECK(!map.isKeyAvailable("c"));
+    map.beginMap();
+    CHECK(!map.hasError());
+}
+
+static void testDepthLimit()
+{
+    // Los niveles proporcionados por el usuario no se suman a un arreglo propio del objeto
+    static_assert(sizeof(MsgPackMapT<2>) == sizeof(MsgPackMapBase) + 2*sizeof(MsgPackFrame),
+                  "MsgPackMapBase no incluye un arreglo de niveles");
+    MsgPackFrame frames[2];
+    MsgPackMapBase map(buf,sizeof(buf),frames,2);
+    map.clearData();
+    map.beginMap();
+    map.beginSubMap("a");
+    map.beginSubMap("b");
+    map.addInteger("x",(uint8_t)1);
+    map.endSubMap();
+    map.endSubMap();
+    map.endMap();
+    CHECK(!map.hasError());
+    CHECK(map.isPathAvailable("a.b.x"));
+
+    map.clearData();
+    map.beginMap();
+    map.beginSubMap("a");
+    map.beginSubMap("b");
+    map.beginSubMap("c");
+    CHECK(map.hasError());
+
+    MsgPackMapT<2> owned(buf,sizeof(buf));
+    owned.clearData();
+    owned.beginMap();
+    owned.beginSubMap("a");
+    owned.beginSubMap("b");
+    CHECK(!owned.hasError());
+    owned.beginSubMap("c");
+    CHECK(owned.hasError());
+}
+
+static void testHostileData()
+{
+    const char longKey[] = "clave_de_mas_de_treinta_y_dos_caracteres";
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    map.addInteger(longKey,(uint8_t)7);
+    map.addInteger("a",(uint8_t)1);
+    map.endMap();
+    CHECK(map.readUnsignedInt8(longKey) == 7);
+    // Una clave larga que no existe termina la busqueda
+    CHECK(!map.isKeyAvailable("clave_de_mas_de_treinta_y_dos_caracterez"));
+
+    // Clave al final de los datos sin valor, cabecera con un tamano mayor que los datos
+    // y clave cortada: ninguna lectura sale del mensaje recibido
+    byte noValue[] = {0x81,0xa1,'a'};
+    byte bigString[] = {0x81,0xa1,'s',0xd9,0xff,'x'};
+    byte cutKey[] = {0x81,0xd9,40,'c','l'};
+    MsgPackMap a(noValue,sizeof(noValue));
+    MsgPackMap b(bigString,sizeof(bigString));
+    MsgPackMap c(cutKey,sizeof(cutKey));
+    CHECK(!a.isKeyAvailable("a"));
+    CHECK(!b.isKeyAvailable("s") && b.readString("s") == "");
+    CHECK(!c.isKeyAvailable(longKey));
+    uint8_t value;
+    CHECK(a.read("a",value) == MSGPACK_NOT_FOUND);
+    CHECK(b.readPath("s",value) == MSGPACK_NOT_FOUND);
+
+    // Una cadena que contiene la clave seguida de un byte invalido no oculta la clave real
+    map.clearData();
+    map.beginMap();
+    map.addString("s","\xa1" "b\xc1");
+    map.addInteger("b",(uint8_t)5);
+    map.endMap();
+    CHECK(map.isKeyAvailable("b") && map.readUnsignedInt8("b") == 5);
+
+    // La busqueda se limita a los datos de la estructura y no recorre todo el buffer
+    map.clearData();
+    map.beginMap();
+    map.addInteger("a",(uint8_t)1);
+    map.endMap();
+    memcpy(buf+map.getMapSize(),"\xa1z\x05",3);
+    CHECK(!map.isKeyAvailable("z"));
+}
+
+static void testAttachData()
+{
+    byte rx[64];
+    MsgPackMap map(rx,sizeof(rx));
+    map.clearData();
+    map.beginMap();
+    map.addInteger("a",(uint8_t)1);
+    map.addInteger("old",(uint8_t)2);
+    map.endMap();
+
+    // Un mensaje mas corto recibido en el mismo buffer deja datos del anterior
+    byte msg[] = {0x81,0xa1,'b',0x03};
+    memcpy(rx,msg,sizeof(msg));
+    MsgPackMap reader(rx,sizeof(rx));
+    CHECK(reader.isKeyAvailable("old"));
+    reader.attachData(rx,sizeof(msg));
+    CHECK(!reader.isKeyAvailable("old"));
+    CHECK(reader.readUnsignedInt8("b") == 3);
+    CHECK(reader.readNumElements() == 1);
+    CHECK(reader.getMapSize() == sizeof(msg));
+    MsgPackIterator it(reader);
+    int n = 0;
+    while(it.next())
+        n++;
+    CHECK(n == 1 && !it.hasError());
+
+    // Un mensaje cortado no es valido aunque el buffer contenga el resto
+    reader.attachData(rx,sizeof(msg) - 1);
+    CHECK(!reader.isKeyAvailable("b"));
+    MsgPackIterator cut(reader);
+    while(cut.next());
+    CHECK(cut.hasError());
+    reader.attachData(rx,0);
+    CHECK(reader.readNumElements() == 0 && !reader.isKeyAvailable("b"));
+}
+
+static void testAttachAndEncode()
+{
+    byte tx[64];
+    byte msg[] = {0x81,0xa1,'b',0x03};
+    MsgPackMap map(tx,sizeof(tx));
+    map.clearData();
+    map.beginMap();
+    map.addString("s","cadena de mas de cuatro bytes");
+    map.endMap();
+    CHECK(!map.hasError());
+
+    // Recepcion: el mensaje no modifica el buffer ni la capacidad del objeto
+    map.attachData(msg,sizeof(msg));
+    CHECK(map.readUnsignedInt8("b") == 3 && !map.isKeyAvailable("s"));
+    map.addInteger("x",(uint8_t)1);
+    CHECK(map.hasError());
+    CHECK(msg[3] == 0x03);
+
+    // Codificacion en el buffer propio con su tamano completo
+    map.beginMap();
+    map.addString("s","otra cadena de mas de cuatro bytes");
+    map.addInteger("n",(uint16_t)500);
+    map.endMap();
+    CHECK(!map.hasError());
+    CHECK(map.getMapSize() > sizeof(msg));
+    CHECK(map.readUnsignedInt16("n") == 500 && !map.isKeyAvailable("b"));
+
+    // Los datos de una codificacion anterior mas larga no se encuentran
+    map.beginMap();
+    map.addInteger("a",(uint8_t)1);
+    map.endMap();
+    CHECK(map.getMapSize() == 4);
+    CHECK(!map.isKeyAvailable("n") && map.readUnsignedInt8("a") == 1);
+
+    // Un mensaje recibido en el buffer propio se lee completo al asociarlo con attachData()
+    byte longer[] = {0x82,0xa1,'a',0x01,0xa1,'z',0x02};
+    memcpy(tx,longer,sizeof(longer));
+    CHECK(!map.isKeyAvailable("z"));
+    map.attachData(tx,sizeof(longer));
+    CHECK(map.readUnsignedInt8("z") == 2 && map.getMapSize() == sizeof(longer));
+    map.clearData();
+    memcpy(tx,longer,sizeof(longer));
+    CHECK(map.readUnsignedInt8("z") == 2);
+}
+
+static void testReadCursor()
+{
+    char key[4] = "k00";
+    MsgPackMap map(buf,sizeof(buf));
+    map.clearData();
+    map.beginMap();
+    for(uint8_t i=0;i<20;i++)
+    {
+        key[1] = '0' + i/10;
+        key[2] = '0' + i%10;
+        map.addInteger(key,i);
+    }
+    map.beginSubMap("s");
+    map.addInteger("k00",(uint8_t)100);
+    map.endSubMap();
+    map.endMap();
+    CHECK(!map.hasError());
+
+    map.setReadCursor(true);
+    bool ok = true;
+    for(uint8_t i=0;i<20;i++)
+    {
+        key[1] = '0' + i/10;
+        key[2] = '0' + i%10;
+        ok = ok && map.readUnsignedInt8(key) == i;
+    }
+    CHECK(ok);
+    // Fuera de orden la busqueda vuelve al inicio; las claves repetidas se encuentran
+    // a partir del cursor
+    CHECK(map.readUnsignedInt8("k05") == 5);
+    CHECK(map.readUnsignedInt8("k00") == 100);
+    CHECK(map.readUnsignedInt8("k00") == 0);
+    CHECK(!map.isKeyAvailable("none"));
+    CHECK(map.readUnsignedInt8("k19") == 19);
+    map.setReadCursor(false);
+    CHECK(map.readUnsignedInt8("k00") == 0);
+}
+
+static const MsgPackKey dictionary[] = {"temperature","humidity","imu","x"};
+static_assert(MsgPackKey("temperature").length == 11 && MsgPackKey("temperature").hashed,
+              "Las claves literales se calculan en compilacion");
+
+static void testKeyDictionary()
+{
+    MsgPackIndexEntry index[8];
+    MsgPackMap map(buf,sizeof(buf));
+    map.setKeyDictionary(dictionary);
+    map.clearData();
+    map.beginMap();
+    map.addFloat("temperature",21.5f);
+    map.addInteger("humidity",(uint8_t)40);
+    map.addInteger("other",(uint8_t)3);
+    map.beginSubMap("imu");
+    map.addInteger("x",(uint8_t)0);
+    map.endSubMap();
+    map.endMap();
+    CHECK(!map.hasError());
+    // Las claves del diccionario ocupan un byte, las demas se escriben como cadena
+    CHECK(buf[1] == 0x00 && buf[2] == 0xca);
+    CHECK(buf[7] == 0x01 && buf[8] == 40);
+    CHECK(buf[9] == 0xa5);
+
+    CHECK(map.readFloat("temperature") == 21.5f);
+    CHECK(map.readUnsignedInt8("humidity") == 40);
+    CHECK(map.readUnsignedInt8("other") == 3);
+    CHECK(map.isPathAvailable("imu.x"));
+    CHECK(map.buildIndex(index,8));
+    CHECK(map.readUnsignedInt8(MsgPackKey("humidity")) == 40);
+    CHECK(map.isPathAvailable("imu.x"));
+    map.clearIndex();
+
+    MsgPackIterator it(map);
+    CHECK(it.next() && it.keySize() == 11 && memcmp(it.key(),"temperature",11) == 0);
+
+    // Sin el diccionario solo se encuentran las claves de texto
+    MsgPackMap plain(buf,map.getMapSize());
+    CHECK(!plain.isKeyAvailable("temperature"));
+    CHECK(plain.readUnsignedInt8("other") == 3);
+}
+
+int main()
+{
+    RUN_TEST(testSubMaps);
+    RUN_TEST(testLargeMaps);
+    RUN_TEST(testIndex);
+    RUN_TEST(testBufferLimit);
+    RUN_TEST(testDepthLimit);
+    RUN_TEST(testHostileData);
+    RUN_TEST(testAttachData);
+    RUN_TEST(testAttachAndEncode);
+    RUN_TEST(testReadCursor);
+    RUN_TEST(testKeyDictionary);
+    return TEST_RESULT();
+}
@@ -0,0 +1,190 @@
+#include "MsgPackBatch.h"
+#include "Arduino.h"
+#include <string.h>
+
+/**
+  *  @brief Constructor del objeto. Las filas se copian sin serializar en el arreglo
+  *         proporcionado, de manera que agregar una fila solo cuesta una copia de memoria;
+  *         la serializacin se realiza una sola vez por lote en encode(), cuando ya se
+  *         conoce el nmero de filas y las cabeceras se escriben con su tamao final.
+  *  @param map         Mapa donde se serializa el lote.
+  *  @param fields      Arreglo de descriptores de los miembros de cada fila (ver MSGPACK_FIELD).
+  *                     Las claves se escriben una vez por fila (MSGPACK_BATCH_ROWS) o una
+  *                     vez por lote (MSGPACK_BATCH_COLUMNS).
+  *  @param numFields   Nmero de descriptores.
+  *  @param rows        Arreglo donde se almacenan las filas.
+  *  @param rowsSize    Tamao del arreglo en bytes.
+  *  @param rowSize     Tamao de cada fila en bytes (sizeof de la estructura).
+  *  @return none
+  */
+MsgPackBatch::MsgPackBatch(MsgPackMapBase &map, const MsgPackField fields[], uint8_t numFields, byte rows[], uint16_t rowsSize, uint16_t rowSize)
+{
+    this->map = &map;
+    this->fields = fields;
+    this->numFields = numFields;
+    this->rows = rows;
+    this->rowSize = rowSize;
+    maxRows = rowSize > 0 ? rowsSize/rowSize : 0;
+    flushSize = maxRows;
+}
+
+/**
+  *  @brief Define el formato del lote serializado.
+  *  @param mode        MSGPACK_BATCH_ROWS para un arreglo de mapas (una fila por mapa) o
+  *                     MSGPACK_BATCH_COLUMNS para un mapa de arreglos (un arreglo por
+  *                     miembro, las claves se escriben una sola vez).
+  *  @return none
+  */
+void MsgPackBatch::setMode(uint8_t mode)
+{
+    this->mode = mode;
+}
+
+/**
+  *  @brief Define el nmero de filas a partir del cual isFlushDue() indica que se debe
+  *         enviar el lote. Por defecto es la capacidad del arreglo de filas.
+  *  @param numRows     Nmero de filas (se limita a la capacidad del arreglo).
+  *  @return none
+  */
+void MsgPackBatch::setFlushSize(uint16_t numRows)
+{
+    flushSize = numRows < maxRows ? numRows : maxRows;
+}
+
+/**
+  *  @brief Define el tiempo mximo que una fila espera en el lote. isFlushDue() indica que
+  *         se debe enviar el lote cuando la primera fila tiene este tiempo en el lote.
+  *  @param interval    Tiempo en milisegundos, 0 para desactivar (por defecto).
+  *  @return none
+  */
+void MsgPackBatch::setFlushInterval(uint32_t interval)
+{
+    flushInterval = interval;
+}
+
+/**
+  *  @brief Define si un miembro entero se serializa como arreglo comprimido (ver
+  *         MsgPackMap::addDeltaArray()) en el modo MSGPACK_BATCH_COLUMNS. Conviene para
+  *         contadores y marcas de tiempo, cuyos valores cambian poco entre filas. Los
+  *         miembros que no son enteros o con ndice mayor a 31 se serializan sin comprimir.
+  *  @param field       ndice del miembro en el arreglo de descriptores.
+  *  @param enable      True para comprimir el miembro, false para serializarlo sin comprimir.
+  *  @return none
+  */
+void MsgPackBatch::setDeltaEncoding(uint8_t field, bool enable)
+{
+    if(field >= 32)
+        return;
+    if(enable)
+        deltaFields |= (uint32_t)1 << field;
+    else
+        deltaFields &= ~((uint32_t)1 << field);
+}
+
+/**
+  *  @brief Agrega una fila al lote.
+  *  @param row         Direccin de memoria de la estructura con los datos de la fila.
+  *  @return bool       True si se agreg la fila, false si el lote est lleno.
+  */
+bool MsgPackBatch::addRow(const void *row)
+{
+    if(numRows >= maxRows)
+        return false;
+    if(numRows == 0)
+        firstRowTime = millis();
+    memcpy(rows+((uint32_t)numRows*rowSize),row,rowSize);
+    numRows++;
+    return true;
+}
+
+/**
+  *  @brief Devuelve el nmero de filas del lote.
+  *  @return uint16_t   Nmero de filas.
+  */
+uint16_t MsgPackBatch::getNumRows()
+{
+    return numRows;
+}
+
+/**
+  *  @brief Indica si el lote alcanz el nmero de filas definido con setFlushSize() o si
+  *         la primera fila excedi el tiempo definido con setFlushInterval().
+  *  @return bool       True si se debe serializar y enviar el lote, false en caso contrario.
+  */
+bool MsgPackBatch::isFlushDue()
+{
+    if(numRows == 0)
+        return false;
+    if(numRows >= flushSize)
+        return true;
+    return flushInterval > 0 && millis() - firstRowTime >= flushInterval;
+}
+
+/**
+  *  @brief Serializa el lote como un elemento del mapa actual de map, de manera que se
+  *         puede combinar con otros elementos (por ejemplo, el identificador del equipo).
+  *         Las filas se conservan hasta llamar a clear().
+  *  @param key         Clave del elemento.
+  *  @return bool       True si el lote cupo en el buffer, false en caso contrario (ver
+  *                     MsgPackMap::hasError()).
+  */
+bool MsgPackBatch::encode(const MsgPackKey &key)
+{
+    if(mode == MSGPACK_BATCH_COLUMNS)
+    {
+        map->beginSubMap(key,numFields);
+        for(uint8_t i=0;i<numFields;i++)
+        {
+            if(i < 32 && (deltaFields & ((uint32_t)1 << i)) && MsgPackMapBase::isIntegerField(fields[i].type))
+            {
+                uint32_t maxSize = 7 + (uint32_t)numRows*MsgPackMapBase::maxVarintSize(fields[i].size);
+                if(map->beginElement(fields[i].key,maxSize))
+                {
+                    map->serializeKey(fields[i].key);
+                    map->serializeDeltaArray(rows+fields[i].offset,numRows,rowSize,fields[i].type);
+                    map->endElement();
+                }
+                continue;
+            }
+            map->beginArray(fields[i].key,numRows);
+            for(uint16_t j=0;j<numRows;j++)
+            {
+                if(!map->beginElement(false,3 + (uint32_t)fields[i].size))
+                    break;
+                map->serializeField(rows+((uint32_t)j*rowSize),fields[i]);
+                map->endElement();
+            }
+            map->endArray();
+        }
+        map->endSubMap();
+    }
+    else
+    {
+        map->beginArray(key,numRows);
+        for(uint16_t j=0;j<numRows;j++)
+        {
+            map->beginContainer(NULL,numFields,false);
+            map->addStruct(rows+((uint32_t)j*rowSize),fields,numFields);
+            map->endSubMap();
+        }
+        map->endArray();
+    }
+    return !map->hasError();
+}
+
+/**
+  *  @brief Equivalente a encode() con la clave como cadena de caracteres.
+  */
+bool MsgPackBatch::encode(const char keyStr[])
+{
+    return encode(MsgPackKey(keyStr,strlen(keyStr)));
+}
+
+/**
+  *  @brief Descarta las filas del lote, normalmente despus de enviarlo.
+  *  @return none
+  */
+void MsgPackBatch::clear()
+{
+    numRows = 0;
+}
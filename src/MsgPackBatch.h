@@ -0,0 +1,47 @@
+#ifndef MsgPackBatch_h
+#define MsgPackBatch_h
+
+#include "Arduino.h"
+#include "MsgPackMap.h"
+
+#define MSGPACK_BATCH_ROWS 0
+#define MSGPACK_BATCH_COLUMNS 1
+
+class MsgPackBatch
+{
+    public:
+        MsgPackBatch(MsgPackMapBase &map, const MsgPackField fields[], uint8_t numFields, byte rows[], uint16_t rowsSize, uint16_t rowSize);
+        // Lote a partir de un arreglo de estructuras: el tamano de cada fila es sizeof(T)
+        template<typename T, size_t N, size_t R> MsgPackBatch(MsgPackMapBase &map, const MsgPackField (&fields)[N], T (&rows)[R])
+            : MsgPackBatch(map,fields,N,(byte*)rows,sizeof(rows),sizeof(T))
+        {
+            static_assert(sizeof(rows) <= 0xFFFF,"Las filas del lote no pueden ocupar mas de 65535 bytes");
+            static_assert(N <= 0xFF,"El lote admite hasta 255 miembros");
+        }
+        void setMode(uint8_t mode);
+        void setFlushSize(uint16_t numRows);
+        void setFlushInterval(uint32_t interval);
+        void setDeltaEncoding(uint8_t field, bool enable);
+
+        bool addRow(const void *row);
+        uint16_t getNumRows();
+        bool isFlushDue();
+        bool encode(const char keyStr[]);
+        bool encode(const MsgPackKey &key);
+        void clear();
+
+    private:
+        MsgPackMapBase *map;
+        const MsgPackField *fields;
+        uint8_t numFields;
+        byte *rows;             // Filas almacenadas sin serializar
+        uint16_t rowSize;
+        uint16_t maxRows;
+        uint16_t numRows = 0;
+        uint16_t flushSize;
+        uint32_t flushInterval = 0;
+        uint32_t firstRowTime = 0;
+        uint8_t mode = MSGPACK_BATCH_ROWS;
+        uint32_t deltaFields = 0; // Bit i: el miembro i se comprime en modo de columnas
+};
+#endif // MsgPackBatch_h
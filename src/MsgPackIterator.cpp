@@ -0,0 +1,220 @@
+#include "MsgPackIterator.h"
+#include "Arduino.h"
+
+/**
+  *  @brief Constructor del objeto. Recorre los elementos del mapa principal de la
+  *         estructura, la cual no se modifica ni se copia.
+  *  @param map         Mapa a recorrer.
+  *  @return none
+  */
+MsgPackIterator::MsgPackIterator(MsgPackMapBase &map) : MsgPackIterator(&map,0)
+{
+}
+
+/**
+  *  @brief Constructor para recorrer el mapa o arreglo que inicia en containerPos
+  *         (ver enter()).
+  *  @param map             Mapa que contiene la estructura.
+  *  @param containerPos    Posicin de la cabecera del mapa o arreglo, -1 para un
+  *                         recorrido vaco.
+  *  @return none
+  */
+MsgPackIterator::MsgPackIterator(MsgPackMapBase *map, int containerPos)
+{
+    uint32_t payload, children;
+    this->map = map;
+    if(containerPos < 0)
+        return;
+    uint16_t end = map->getDataEnd();
+    if(containerPos >= end || containerPos + MsgPackMapBase::headerSize(*(map->buffer+containerPos)) > end)
+    {
+        error = true;
+        return;
+    }
+    byte tag = *(map->buffer+containerPos);
+    isMap = (tag & 0xf0) == 0x80 || tag == 0xde || tag == 0xdf;
+    if(!isMap && (tag & 0xf0) != 0x90 && tag != 0xdc && tag != 0xdd)
+    {
+        error = true;
+        return;
+    }
+    MsgPackMapBase::elementSize(map->buffer+containerPos,payload,children);
+    remaining = isMap ? children/2 : children;
+    pos = containerPos + MsgPackMapBase::headerSize(tag);
+}
+
+/**
+  *  @brief Avanza al siguiente elemento. La clave y el valor del elemento anterior se
+  *         saltan completos segn su tipo (ver MsgPackMap::skipElement()), sin
+  *         deserializarlos.
+  *  @return bool       True si existe un siguiente elemento, false al terminar el mapa o
+  *                     arreglo o si la estructura no es vlida (ver hasError()).
+  */
+bool MsgPackIterator::next()
+{
+    uint16_t ini, dataSize;
+    if(error || remaining == 0)
+        return false;
+    keyStr = NULL;
+    keyLength = 0;
+    if(isMap)
+    {
+        int end = map->skipElement(pos);
+        if(end == -1)
+        {
+            error = true;
+            return false;
+        }
+        const MsgPackKey *entry = map->dictionaryKey(pos);
+        if(map->getStringData(pos,ini,dataSize))
+        {
+            keyStr = (const char*)(map->buffer+ini);
+            keyLength = dataSize;
+        }
+        else if(entry != NULL)
+        {
+            keyStr = entry->str;
+            keyLength = entry->length;
+        }
+        pos = end;
+    }
+    valPos = pos;
+    valEnd = map->skipElement(pos);
+    if(valEnd == -1)
+    {
+        error = true;
+        return false;
+    }
+    pos = valEnd;
+    remaining--;
+    return true;
+}
+
+/**
+  *  @brief Indica si se encontr un elemento no vlido o que excede el buffer.
+  *  @return bool       True si ocurri un error, false en caso contrario.
+  */
+bool MsgPackIterator::hasError()
+{
+    return error;
+}
+
+/**
+  *  @brief Devuelve los caracteres de la clave del elemento actual. La clave no termina
+  *         en '\0' (ver keySize()).
+  *  @return const char*    Apuntador a la clave dentro del buffer o en el diccionario
+  *                         (ver MsgPackMap::setKeyDictionary()), NULL si el elemento
+  *                         pertenece a un arreglo o su clave no es una cadena.
+  */
+const char *MsgPackIterator::key()
+{
+    return keyStr;
+}
+
+/**
+  *  @brief Devuelve el nmero de caracteres de la clave del elemento actual.
+  *  @return uint16_t   Tamao de la clave, 0 si el elemento no tiene clave.
+  */
+uint16_t MsgPackIterator::keySize()
+{
+    return keyLength;
+}
+
+/**
+  *  @brief Devuelve el tipo del valor del elemento actual.
+  *  @return uint8_t    Tipo del valor (MSGPACK_TYPE_*).
+  */
+uint8_t MsgPackIterator::type()
+{
+    if(valPos == -1)
+        return MSGPACK_TYPE_INVALID;
+    byte tag = *(map->buffer+valPos);
+    if(tag <= 0x7f || tag >= 0xe0 || (tag >= 0xcc && tag <= 0xd3))
+        return MSGPACK_TYPE_INTEGER;
+    if((tag & 0xf0) == 0x80 || tag == 0xde || tag == 0xdf)
+        return MSGPACK_TYPE_MAP;
+    if((tag & 0xf0) == 0x90 || tag == 0xdc || tag == 0xdd)
+        return MSGPACK_TYPE_ARRAY;
+    if((tag & 0xe0) == 0xa0 || (tag >= 0xd9 && tag <= 0xdb))
+        return MSGPACK_TYPE_STRING;
+    switch(tag)
+    {
+        case 0xc0:
+            return MSGPACK_TYPE_NIL;
+        case 0xc2:
+        case 0xc3:
+            return MSGPACK_TYPE_BOOL;
+        case 0xc4:
+        case 0xc5:
+        case 0xc6:
+            return MSGPACK_TYPE_BINARY;
+        case 0xca:
+        case 0xcb:
+            return MSGPACK_TYPE_FLOAT;
+        case 0xc7:
+        case 0xc8:
+        case 0xc9:
+        case 0xd4:
+        case 0xd5:
+        case 0xd6:
+        case 0xd7:
+        case 0xd8:
+            return MSGPACK_TYPE_EXT;
+    }
+    return MSGPACK_TYPE_INVALID;
+}
+
+/**
+  *  @brief Devuelve la posicin en el buffer del valor del elemento actual (cabecera
+  *         incluida).
+  *  @return uint16_t   Posicin del valor.
+  */
+uint16_t MsgPackIterator::valuePos()
+{
+    return valPos;
+}
+
+/**
+  *  @brief Devuelve el tamao en bytes del valor serializado del elemento actual,
+  *         incluyendo la cabecera y el contenido de mapas y arreglos.
+  *  @return uint16_t   Tamao del valor en bytes.
+  */
+uint16_t MsgPackIterator::valueSize()
+{
+    return valEnd - valPos;
+}
+
+/**
+  *  @brief Devuelve el nmero de elementos de un mapa o arreglo, o el nmero de bytes
+  *         de una cadena, un arreglo de bytes o una extensin.
+  *  @return uint32_t   Tamao del valor actual, 0 para los dems tipos.
+  */
+uint32_t MsgPackIterator::size()
+{
+    uint32_t payload, children;
+    uint8_t valueType = type();
+    if(valueType == MSGPACK_TYPE_INVALID)
+        return 0;
+    MsgPackMapBase::elementSize(map->buffer+valPos,payload,children);
+    if(valueType == MSGPACK_TYPE_MAP)
+        return children/2;
+    if(valueType == MSGPACK_TYPE_ARRAY)
+        return children;
+    if(valueType == MSGPACK_TYPE_STRING || valueType == MSGPACK_TYPE_BINARY || valueType == MSGPACK_TYPE_EXT)
+        return payload;
+    return 0;
+}
+
+/**
+  *  @brief Crea un iterador sobre los elementos del submapa o arreglo del elemento actual.
+  *         El iterador actual no se modifica y contina con el siguiente elemento.
+  *  @return MsgPackIterator    Iterador del submapa o arreglo; si el valor actual es de
+  *                             otro tipo el iterador no tiene elementos.
+  */
+MsgPackIterator MsgPackIterator::enter()
+{
+    uint8_t valueType = type();
+    if(valueType != MSGPACK_TYPE_MAP && valueType != MSGPACK_TYPE_ARRAY)
+        return MsgPackIterator(map,-1);
+    return MsgPackIterator(map,valPos);
+}
@@ -0,0 +1,53 @@
+#ifndef MsgPackIterator_h
+#define MsgPackIterator_h
+
+#include "Arduino.h"
+#include "MsgPackMap.h"
+
+#define MSGPACK_TYPE_INVALID 0
+#define MSGPACK_TYPE_NIL 1
+#define MSGPACK_TYPE_BOOL 2
+#define MSGPACK_TYPE_INTEGER 3
+#define MSGPACK_TYPE_FLOAT 4
+#define MSGPACK_TYPE_STRING 5
+#define MSGPACK_TYPE_BINARY 6
+#define MSGPACK_TYPE_ARRAY 7
+#define MSGPACK_TYPE_MAP 8
+#define MSGPACK_TYPE_EXT 9
+
+class MsgPackIterator
+{
+    public:
+        MsgPackIterator(MsgPackMapBase &map);
+        bool next();
+        bool hasError();
+
+        const char *key();
+        uint16_t keySize();
+        uint8_t type();
+        uint16_t valuePos();
+        uint16_t valueSize();
+        uint32_t size();
+        MsgPackIterator enter();
+
+        // Deserializa el valor actual con las mismas reglas que MsgPackMap::read()
+        template<typename T> uint8_t read(T &out)
+        {
+            MsgPackField field = { MsgPackKey(""), MsgPackFieldType<T>::value, 0, sizeof(T) };
+            return map->readField(valPos,field,&out);
+        }
+
+    private:
+        MsgPackIterator(MsgPackMapBase *map, int containerPos);
+
+        MsgPackMapBase *map;
+        int pos = 0;            // Posicion del siguiente elemento
+        uint32_t remaining = 0; // Elementos pendientes del mapa o arreglo
+        bool isMap = false;     // Los elementos de un mapa tienen clave, los de un arreglo no
+        bool error = false;
+        const char *keyStr = NULL; // Caracteres de la clave actual (buffer o diccionario)
+        uint16_t keyLength = 0;
+        int valPos = -1;        // Posicion del valor actual
+        int valEnd = -1;        // Posicion siguiente al valor actual
+};
+#endif // MsgPackIterator_h
@@ -3,54 +3,107 @@
 #include "HardwareSerial.h"
 #include <string.h>
 
+// Conversin de endianness vectorizada en compilaciones para PC (ver swapBytes())
+#if !defined(MSGPACK_NO_SIMD) && defined(__SSSE3__)
+#include <tmmintrin.h>
+#define MSGPACK_SIMD_SSSE3
+#elif !defined(MSGPACK_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define MSGPACK_SIMD_NEON
+#endif
+
 /**
-  *  @brief Constructor del objeto.
+  *  @brief Constructor del objeto con un arreglo de niveles proporcionado por el usuario.
+  *         Cada submapa abierto ocupa un nivel, por lo que el nmero mximo de submapas
+  *         anidados es igual al tamao del arreglo. La clase base no incluye un arreglo
+  *         propio; MsgPackMapT<N> (y MsgPackMap, con MAX_SUBMAPS niveles) lo agregan.
   *  @param buffer      Direccin de memoria del buffer de datos (arreglo de bytes).
   *  @param bufsize     Tamao del buffer.
+  *  @param frames      Arreglo de niveles (debe existir mientras se utilice el objeto).
+  *  @param maxDepth    Nmero de niveles del arreglo (hasta 255).
   *  @return none
   */
-MsgPackMap::MsgPackMap(byte buffer[], uint16_t bufsize)
+MsgPackMapBase::MsgPackMapBase(byte buffer[], uint16_t bufsize, MsgPackFrame frames[], uint8_t maxDepth)
 {
     this->buffer = buffer;
+    mapBuffer = buffer;
     bufferSize = bufsize;
+    this->frames = frames;
+    this->maxDepth = maxDepth;
     numElements = 0;
     startPos = 0;
     bufferPos = 0;
 }
 
 /**
-  *  @brief Deveulve el tamao en bytes de la estructura.
+  *  @brief Deveulve el tamao en bytes de la estructura, o la longitud del mensaje
+  *         asociado con attachData().
   *  @return int    Tamao de la esttructura en bytes
   */
-uint16_t MsgPackMap::getMapSize()
+uint16_t MsgPackMapBase::getMapSize()
 {
+    if(attached)
+        return dataSize;
     if(bufferPos > 0)
         return bufferPos;
     else
         return 0; //aqui va el codigo para detener el map
 }
 
+/**
+  *  @brief Asocia al objeto un mensaje recibido para leerlo. Las bsquedas, los iteradores
+  *         y la validacin de los elementos se limitan a los bytes del mensaje, por lo que
+  *         no se recorre el resto del buffer de recepcin ni se encuentran datos de mensajes
+  *         anteriores ms largos. Se descartan la estructura en construccin y el ndice
+  *         de claves (ver buildIndex()). El buffer del objeto conserva su tamao y se
+  *         vuelve a utilizar al llamar a beginMap() o clearData(); antes de eso no se
+  *         pueden agregar elementos. Un mensaje recibido en el buffer del propio objeto
+  *         tambin se debe asociar con attachData(buffer,longitud): despus de codificar
+  *         una estructura las lecturas se limitan a ella (ver getDataEnd()).
+  *  @param data        Direccin de memoria del mensaje.
+  *  @param length      Longitud del mensaje en bytes.
+  *  @return none
+  */
+void MsgPackMapBase::attachData(byte data[], uint16_t length)
+{
+    buffer = data;
+    dataSize = length;
+    attached = true;
+    bufferPos = 0;
+    numElements = 0;
+    startPos = 0;
+    level = 0;
+    error = false;
+    clearIndex();
+}
+
 /**
   *  @brief Asigna un objeto de tipo Stream para escribir en el. Esta funcin se debe llamar antes de utilizar
   *         writeDara() y printRawData().
   *  @param serial      Direccin de memoria del objeto Stream (monitor serial, etc.).
   *  @return none
   */
-void MsgPackMap::setStream(Stream &serial)
+void MsgPackMapBase::setStream(Stream &serial)
 {
     _serial = &serial;
+    writeSpaceKnown = false;
 }
 
 /**
-  *  @brief Devuelve el nmero de elementos que contiene la estructura.
-  *  @return none
+  *  @brief Devuelve el nmero de elementos que contiene la estructura (hasta 2^32-1 con
+  *         la cabecera map 32).
+  *  @return uint32_t   Nmero de elementos, 0 si los datos no inician con un mapa.
   */
-uint8_t MsgPackMap::readNumElements()
+uint32_t MsgPackMapBase::readNumElements()
 {
+    if(getDataEnd() == 0 || headerSize(*(buffer)) > getDataEnd())
+        return 0;
     if((*(buffer) & 0xf0) == 0x80)
         return (*(buffer) & 0x0f);
     else if((*(buffer) == 0xde))
-        return *(buffer+2);
+        return (*(buffer+1) << 8) | *(buffer+2);
+    else if((*(buffer) == 0xdf))
+        return ((uint32_t)*(buffer+1) << 24) | ((uint32_t)*(buffer+2) << 16) | ((uint32_t)*(buffer+3) << 8) | *(buffer+4);
     else
         return 0;
 }
@@ -62,7 +115,7 @@ uint8_t MsgPackMap::readNumElements()
   *  @param serial      Direccin de memoria del objeto de tipo Stream.
   *  @return none
   */
-void MsgPackMap::printRawData()
+void MsgPackMapBase::printRawData()
 {
     for(int i=0;i<bufferPos;i++)
     {
@@ -84,7 +137,7 @@ void MsgPackMap::printRawData()
   *  @param numCol      Nmero de columnas.
   *  @return none
   */
-void MsgPackMap::printRawData(int numCol)
+void MsgPackMapBase::printRawData(int numCol)
 {
     for(int i=0;i<bufferPos;i++)
     {
@@ -102,14 +155,77 @@ void MsgPackMap::printRawData(int numCol)
 
 /**
   *  @brief Escribe el contenido del buffer en un objeto de tipo Stream (Monitor serie,
-  *         objeto de tipo software serial, etc).
-  *  @param serial    Direccin de memoria del objeto de tipo Stream.
+  *         objeto de tipo software serial, etc). Los datos se envan en bloques de
+  *         tamao writeChunkSize (ver setWriteChunkSize()). La funcin no regresa hasta
+  *         enviar toda la estructura o hasta que el objeto Stream no acepte ms bytes.
+  *  @return uint16_t   Nmero de bytes que no se enviaron, 0 si se envi toda la estructura.
+  */
+uint16_t MsgPackMapBase::writeData()
+{
+    uint16_t len;
+    size_t written;
+    uint16_t i = 0;
+    while(i < bufferPos)
+    {
+        len = bufferPos - i;
+        if(len > writeChunkSize)
+            len = writeChunkSize;
+        written = _serial->write(buffer+i,len);
+        if(written == 0)
+            break;
+        i += written;
+    }
+    return bufferPos - i;
+}
+
+/**
+  *  @brief Define el tamao mximo de los bloques que se envan al objeto Stream en
+  *         writeData() y continueWriteData().
+  *  @param chunkSize   Tamao del bloque en bytes (por defecto WRITE_CHUNK_SIZE).
+  *  @return none
+  */
+void MsgPackMapBase::setWriteChunkSize(uint16_t chunkSize)
+{
+    writeChunkSize = chunkSize > 0 ? chunkSize : 1;
+}
+
+/**
+  *  @brief Inicia el envo no bloqueante de la estructura. Los datos se envan
+  *         posteriormente con llamadas sucesivas a continueWriteData() (por ejemplo
+  *         desde loop()).
   *  @return none
   */
-void MsgPackMap::writeData()
+void MsgPackMapBase::beginWriteData()
+{
+    writePos = 0;
+}
+
+/**
+  *  @brief Enva el siguiente bloque de la estructura sin bloquear. Se escriben como
+  *         mximo writeChunkSize bytes y nunca ms de los que el objeto Stream reporta
+  *         con availableForWrite(), por lo que si el buffer de transmisin est lleno no
+  *         se escribe nada. Muchos objetos Stream (SoftwareSerial, algunos puertos USB)
+  *         no implementan availableForWrite() y siempre devuelven 0; mientras el objeto
+  *         no haya reportado espacio alguna vez se escribe un bloque completo, que puede
+  *         bloquear durante el envo de ese bloque.
+  *  @return uint16_t   Nmero de bytes pendientes de enviar, 0 si se complet el envo.
+  */
+uint16_t MsgPackMapBase::continueWriteData()
 {
-    for(int i=0; i<bufferPos; i++)
-        _serial->write(*(buffer+bufferPos));
+    if(writePos < bufferPos)
+    {
+        int avail = _serial->availableForWrite();
+        uint16_t len = bufferPos - writePos;
+        if(len > writeChunkSize)
+            len = writeChunkSize;
+        if(avail > 0)
+            writeSpaceKnown = true;
+        if(writeSpaceKnown && avail < len)
+            len = avail > 0 ? avail : 0;
+        if(len > 0)
+            writePos += _serial->write(buffer+writePos,len);
+    }
+    return writePos < bufferPos ? bufferPos - writePos : 0;
 }
 
 /**
@@ -118,9 +234,9 @@ void MsgPackMap::writeData()
   *         de elementos del mapa o submapa es mayor a 15.
   *  @return none
   */
-bool MsgPackMap::rearrageBuffer()
+bool MsgPackMapBase::rearrageBuffer()
 {
-    if(bufferPos+3 < bufferSize)
+    if(bufferPos+2 <= bufferSize)
     {
         for(int i=bufferPos-1; i>startPos; i--)
             *(buffer+(i+2)) = *(buffer+i);
@@ -129,22 +245,34 @@ bool MsgPackMap::rearrageBuffer()
     return false;
 }
 
+/**
+  *  @brief Indica si algn elemento no cupo en el buffer desde la ltima llamada a
+  *         beginMap() o clearData(). El indicador se mantiene activo y los elementos
+  *         agregados despus del error se descartan, de manera que basta con consultarlo
+  *         al terminar la estructura. El contenido del buffer no es vlido si ocurri un
+  *         error.
+  *  @return bool       True si ocurri un error, false en caso contrario.
+  */
+bool MsgPackMapBase::hasError()
+{
+    return error;
+}
+
 /**
   *  @brief Limpia el buffer e inicializa la estructura.
   *  @return none
   */
-void MsgPackMap::clearData() //Limpia el buffer
+void MsgPackMapBase::clearData() //Limpia el buffer
 {
+    buffer = mapBuffer;
+    attached = false;
     memset(buffer,0,bufferSize);
     numElements = 0;
     startPos = 0;
     bufferPos = 0;
     level = 0;
-    for(int i=0;i<MAX_SUBMAPS;i++)
-    {
-        positions[i] = 0;
-        elements[i] = 0;
-    }
+    error = false;
+    clearIndex();
 }
 
 /*********************************************************************
@@ -158,7 +286,7 @@ void MsgPackMap::clearData() //Limpia el buffer
   *  @param data    Entero de 8 bits sin signo.
   *  @return none
   */
-void MsgPackMap::serializeInteger(uint8_t data)
+void MsgPackMapBase::serializeInteger(uint8_t data)
 {
     if(data > 127)
         *(buffer+(bufferPos++)) = 0xcc;
@@ -170,7 +298,7 @@ void MsgPackMap::serializeInteger(uint8_t data)
   *  @param data    Entero de 16 bits sin signo.
   *  @return none
   */
-void MsgPackMap::serializeInteger(uint16_t data)
+void MsgPackMapBase::serializeInteger(uint16_t data)
 {
     if(data <= 255)
     {
@@ -189,7 +317,7 @@ void MsgPackMap::serializeInteger(uint16_t data)
   *  @param data    Entero de 32 bits sin signo.
   *  @return none
   */
-void MsgPackMap::serializeInteger(uint32_t data)
+void MsgPackMapBase::serializeInteger(uint32_t data)
 {
     if(data <= 255)
     {
@@ -214,7 +342,7 @@ void MsgPackMap::serializeInteger(uint32_t data)
   *  @param data    Entero de 8 bits con signo.
   *  @return none
   */
-void MsgPackMap::serializeInteger(int8_t data)
+void MsgPackMapBase::serializeInteger(int8_t data)
 {
     if(data >= 0)
     {
@@ -233,7 +361,7 @@ void MsgPackMap::serializeInteger(int8_t data)
   *  @param data    Entero de 16 bits con signo.
   *  @return none
   */
-void MsgPackMap::serializeInteger(int16_t data)
+void MsgPackMapBase::serializeInteger(int16_t data)
 {
     if(data >= 0)
     {
@@ -259,7 +387,7 @@ void MsgPackMap::serializeInteger(int16_t data)
   *  @param data    Entero de 32 bits con signo.
   *  @return none
   */
-void MsgPackMap::serializeInteger(int32_t data)
+void MsgPackMapBase::serializeInteger(int32_t data)
 {
     if(data >= 0)
     {
@@ -286,12 +414,54 @@ void MsgPackMap::serializeInteger(int32_t data)
     }
 }
 
+/**
+  *  @brief Serializa y escribe en el buffer un entero de 64 bits sin signo.
+  *  @param data    Entero de 64 bits sin signo.
+  *  @return none
+  */
+void MsgPackMapBase::serializeInteger(uint64_t data)
+{
+    if(data <= 0xffffffff)
+    {
+        serializeInteger((uint32_t)data);
+    }
+    else
+    {
+        *(buffer+(bufferPos++)) = 0xcf;
+        for(int i=56;i>=0;i=i-8)
+            *(buffer+(bufferPos++)) = (data >> i) & 0xff;
+    }
+}
+
+/**
+  *  @brief Serializa y escribe en el buffer un entero de 64 bits con signo.
+  *  @param data    Entero de 64 bits con signo.
+  *  @return none
+  */
+void MsgPackMapBase::serializeInteger(int64_t data)
+{
+    if(data >= 0)
+    {
+        serializeInteger((uint64_t)data);
+    }
+    else if(data >= -2147483647-1)
+    {
+        serializeInteger((int32_t)data);
+    }
+    else
+    {
+        *(buffer+(bufferPos++)) = 0xd3;
+        for(int i=56;i>=0;i=i-8)
+            *(buffer+(bufferPos++)) = ((uint64_t)data >> i) & 0xff;
+    }
+}
+
 /**
   *  @brief Serializa y escribe en el buffer un nmero de punto flotante de 4 bytes.
   *  @param data    Nmero de punto flotante de 4 bytes.
   *  @return none
   */
-void MsgPackMap::serializeFloat(float data)
+void MsgPackMapBase::serializeFloat(float data)
 {
     dec.num = data;
     *(buffer+(bufferPos++)) = 0xca;
@@ -301,12 +471,35 @@ void MsgPackMap::serializeFloat(float data)
     *(buffer+(bufferPos++)) = dec.numBytes[0];
 }
 
+/**
+  *  @brief Serializa y escribe en el buffer un nmero de punto flotante de 8 bytes. Si el
+  *         valor se puede representar sin prdida con 4 bytes se utiliza el formato float 32.
+  *         En las plataformas donde double es de 4 bytes (AVR) siempre se utiliza float 32.
+  *  @param data    Nmero de punto flotante de 8 bytes.
+  *  @return none
+  */
+void MsgPackMapBase::serializeDouble(double data)
+{
+    if(sizeof(double) != 8 || (double)(float)data == data)
+    {
+        serializeFloat((float)data);
+    }
+    else
+    {
+        uint64_t tmp;
+        memcpy(&tmp,&data,sizeof(tmp));
+        *(buffer+(bufferPos++)) = 0xcb;
+        for(int i=56;i>=0;i=i-8)
+            *(buffer+(bufferPos++)) = (tmp >> i) & 0xff;
+    }
+}
+
 /**
   *  @brief Serializa y escribe en el buffer una variable booleana.
   *  @param data    Valor booleano.
   *  @return none
   */
-void MsgPackMap::serializeBool(bool data)
+void MsgPackMapBase::serializeBool(bool data)
 {
     *(buffer+(bufferPos++)) = data ? 0xc3 : 0xc2;
 }
@@ -315,1468 +508,3837 @@ void MsgPackMap::serializeBool(bool data)
   *  @brief Serializa y escribe en el buffer el valor nulo.
   *  @return none
   */
-void MsgPackMap::serializeNil()
+void MsgPackMapBase::serializeNil()
 {
     *(buffer+(bufferPos++)) = 0xc0;
 }
 
 /**
   *  @brief Serializa y escribe en el buffer una cadena de caracteres.
-  *  @param data    Cadena a escribir. Soporta los formatos fix str y str 8
-  *                 (tamao mximo de 256 caracteres).
+  *  @param data    Cadena a escribir. Soporta los formatos fix str, str 8 y str 16
+  *                 (tamao mximo de 65535 caracteres).
+  *  @return none
+  */
+void MsgPackMapBase::serializeString(const char data[])
+{
+    serializeString(data,strlen(data));
+}
+
+/**
+  *  @brief Serializa y escribe en el buffer una cadena de caracteres de tamao conocido
+  *         con el formato ms pequeo posible.
+  *  @param data        Caracteres a escribir (no requiere terminar en '\0').
+  *  @param dataSize    Nmero de caracteres (hasta 65535).
   *  @return none
   */
-void MsgPackMap::serializeString(const char data[])
+void MsgPackMapBase::serializeString(const char data[], uint16_t dataSize)
 {
-    uint8_t dataSize = strlen(data);
-    if(dataSize <= 32)
+    if(dataSize < 32)
     {
         *(buffer+(bufferPos++)) = (0xa0 + dataSize);
     }
-    else
+    else if(dataSize <= 255)
     {
         *(buffer+(bufferPos++)) = 0xd9;
         *(buffer+(bufferPos++)) = dataSize;
     }
-    for(int i=0;i<dataSize;i++)
-        *(buffer+(bufferPos++)) = data[i];
+    else
+    {
+        *(buffer+(bufferPos++)) = 0xda;
+        *(buffer+(bufferPos++)) = (dataSize >> 8);
+        *(buffer+(bufferPos++)) = (dataSize & 0xff);
+    }
+    memcpy(buffer+bufferPos,data,dataSize);
+    bufferPos = bufferPos + dataSize;
+}
+
+/**
+  *  @brief Serializa y escribe en el buffer una clave como cadena (fix str, str 8 o
+  *         str 16). Si la clave pertenece al diccionario (ver setKeyDictionary()) se
+  *         escribe su ndice en un solo byte.
+  *  @param key     Clave a escribir.
+  *  @return none
+  */
+void MsgPackMapBase::serializeKey(const MsgPackKey &key)
+{
+    int16_t id = keyId(key);
+    if(id != -1)
+    {
+        *(buffer+(bufferPos++)) = id;
+        return;
+    }
+    serializeString(key.str,key.length);
 }
 
 /**
-  *  @brief Serializa y escribe en el buffer un arreglo de bytes.
+  *  @brief Serializa y escribe en el buffer un arreglo de bytes con el formato bin 8
+  *         o bin 16.
   *  @param data        Arreglo de bytes.
-  *  @param dataSize    Tamao del arreglo (hasta 256 elementos).
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
   *  @return none
   */
-void MsgPackMap::serializeByte(byte data[],uint8_t dataSize)
+void MsgPackMapBase::serializeByte(byte data[],uint16_t dataSize)
 {
-    if(dataSize > 0)
+    if(dataSize <= 255)
     {
         *(buffer+(bufferPos++)) = 0xc4;
         *(buffer+(bufferPos++)) = dataSize;
-        for(int i=0;i<dataSize;i++)
-            *(buffer+(bufferPos++)) = data[i];
     }
+    else
+    {
+        *(buffer+(bufferPos++)) = 0xc5;
+        *(buffer+(bufferPos++)) = (dataSize >> 8);
+        *(buffer+(bufferPos++)) = (dataSize & 0xff);
+    }
+    memcpy(buffer+bufferPos,data,dataSize);
+    bufferPos = bufferPos + dataSize;
 }
 
 /**
-  *  @brief Serializa y escribe en el buffer un arreglo de nmeros de punto flotante de 4 bytes.
-  *  @param data        Arreglo de nmeros de punto flotante.
-  *  @param dataSize    Tamao del arreglo (hasta 256 elementos).
+  *  @brief Serializa y escribe en el buffer la cabecera de un arreglo (fix array o array 16).
+  *  @param dataSize    Nmero de elementos del arreglo.
   *  @return none
   */
-void MsgPackMap::serializeFloatArray(float data[],uint8_t dataSize)
+void MsgPackMapBase::serializeArrayHeader(uint16_t dataSize)
 {
-    if(dataSize > 0)
+    if(dataSize < 16)
     {
-        if(dataSize < 16)
-        {
-            *(buffer+(bufferPos++)) = 0x90 + dataSize;
-        }
-        else
-        {
-            *(buffer+(bufferPos++)) = 0xdc;
-            *(buffer+(bufferPos++)) = 0x00;
-            *(buffer+(bufferPos++)) = dataSize;
-        }
-        for(int i=0;i<dataSize;i++)
-            serializeFloat(data[i]);
+        *(buffer+(bufferPos++)) = 0x90 + dataSize;
+    }
+    else
+    {
+        *(buffer+(bufferPos++)) = 0xdc;
+        *(buffer+(bufferPos++)) = (dataSize >> 8);
+        *(buffer+(bufferPos++)) = (dataSize & 0xff);
     }
 }
 
 /**
-  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 8 bits sin signo.
-  *  @param data        Arreglo de enteros de 8 bits sin signo.
-  *  @param dataSize    Tamao del arreglo (hasta 256 elementos).
+  *  @brief Serializa y escribe en el buffer un arreglo numrico tipado con el formato ext
+  *         (tipo MSGPACK_EXT_TYPED_ARRAY). Los datos se componen del tipo de los elementos
+  *         (MSGPACK_FIELD_*) y de los elementos en big endian con el tamao de su tipo, sin
+  *         etiqueta individual, de manera que se escriben con una sola copia.
+  *  @param data        Arreglo de elementos.
+  *  @param dataSize    Nmero de elementos.
+  *  @param type        Tipo de los elementos (MSGPACK_FIELD_*).
+  *  @param size        Tamao de cada elemento en bytes.
   *  @return none
   */
-void MsgPackMap::serializeIntegerArray(uint8_t data[],uint8_t dataSize)
+void MsgPackMapBase::serializeTypedArray(const void *data, uint16_t dataSize, uint8_t type, uint8_t size)
 {
-    if(dataSize > 0)
+    uint32_t length = 1 + (uint32_t)dataSize*size;
+    if(length <= 0xff)
     {
-        if(dataSize < 16)
-        {
-            *(buffer+(bufferPos++)) = 0x90 + dataSize;
-        }
-        else
-        {
-            *(buffer+(bufferPos++)) = 0xdc;
-            *(buffer+(bufferPos++)) = 0x00;
-            *(buffer+(bufferPos++)) = dataSize;
-        }
-        for(int i=0;i<dataSize;i++)
-            serializeInteger(data[i]);
+        *(buffer+(bufferPos++)) = 0xc7;
+        *(buffer+(bufferPos++)) = length;
+    }
+    else if(length <= 0xffff)
+    {
+        *(buffer+(bufferPos++)) = 0xc8;
+        *(buffer+(bufferPos++)) = length >> 8;
+        *(buffer+(bufferPos++)) = length & 0xff;
+    }
+    else
+    {
+        *(buffer+(bufferPos++)) = 0xc9;
+        *(buffer+(bufferPos++)) = length >> 24;
+        *(buffer+(bufferPos++)) = (length >> 16) & 0xff;
+        *(buffer+(bufferPos++)) = (length >> 8) & 0xff;
+        *(buffer+(bufferPos++)) = length & 0xff;
     }
+    *(buffer+(bufferPos++)) = MSGPACK_EXT_TYPED_ARRAY;
+    *(buffer+(bufferPos++)) = type;
+    swapBytes(buffer+bufferPos,(const byte*)data,dataSize,size);
+    bufferPos = bufferPos + (uint32_t)dataSize*size;
 }
 
 /**
-  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 16 bits sin signo.
-  *  @param data        Arreglo de enteros de 16 bits sin signo.
-  *  @param dataSize    Tamao del arreglo (hasta 256 elementos).
+  *  @brief Serializa y escribe en el buffer un arreglo de enteros comprimido con el formato
+  *         ext (tipo MSGPACK_EXT_DELTA_ARRAY). Los datos se componen del tipo de los
+  *         elementos (MSGPACK_FIELD_*) y, por cada elemento, de su diferencia con el anterior
+  *         (el primero con 0) codificada en zigzag y LEB128: las diferencias pequeas ocupan
+  *         un byte sin importar el tamao del tipo. El nmero de elementos no se escribe, se
+  *         obtiene al decodificar los datos.
+  *  @param data        Direccin del primer elemento.
+  *  @param dataSize    Nmero de elementos.
+  *  @param stride      Distancia en bytes entre elementos consecutivos (sizeof del tipo para
+  *                     un arreglo, sizeof de la estructura para un miembro de varias filas).
+  *  @param type        Tipo de los elementos (MSGPACK_FIELD_*).
   *  @return none
   */
-void MsgPackMap::serializeIntegerArray(uint16_t data[],uint8_t dataSize)
+void MsgPackMapBase::serializeDeltaArray(const byte data[], uint16_t dataSize, uint16_t stride, uint8_t type)
 {
-    if(dataSize > 0)
+    uint16_t start = bufferPos;
+    int64_t prev = 0;
+    bufferPos = start + 3;
+    *(buffer+(bufferPos++)) = type;
+    for(uint16_t i=0;i<dataSize;i++)
     {
-        if(dataSize < 16)
+        int64_t value = loadInteger(data+((uint32_t)i*stride),type);
+        uint64_t delta = (uint64_t)value - (uint64_t)prev;
+        uint64_t zigzag = (delta << 1) ^ (uint64_t)(-(int64_t)(delta >> 63));
+        prev = value;
+        while(zigzag >= 0x80)
         {
-            *(buffer+(bufferPos++)) = 0x90 + dataSize;
+            *(buffer+(bufferPos++)) = (zigzag & 0x7f) | 0x80;
+            zigzag = zigzag >> 7;
         }
-        else
-        {
-            *(buffer+(bufferPos++)) = 0xdc;
-            *(buffer+(bufferPos++)) = 0x00;
-            *(buffer+(bufferPos++)) = dataSize;
-        }
-        for(int i=0;i<dataSize;i++)
-            serializeInteger(data[i]);
+        *(buffer+(bufferPos++)) = zigzag;
     }
+    endExtPayload(start,MSGPACK_EXT_DELTA_ARRAY);
 }
 
 /**
-  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 32 bits.
-  *  @param data        Arreglo de enteros de 32 bits.
-  *  @param dataSize    Tamao del arreglo (hasta 256 elementos).
+  *  @brief Escribe la cabecera ext de unos datos cuyo tamao no se conoce al iniciar la
+  *         serializacin. Los datos se escriben a partir de start + 3, despus de una
+  *         cabecera ext 8; si resultan ms grandes se desplazan para dar lugar a la cabecera
+  *         ext 16 o ext 32 (beginElement() ya reserv el tamao mximo).
+  *  @param start       Posicin de la cabecera, bufferPos apunta al final de los datos.
+  *  @param extType     Tipo de extensin (MSGPACK_EXT_*).
   *  @return none
   */
-void MsgPackMap::serializeIntegerArray(uint32_t data[],uint8_t dataSize)
+void MsgPackMapBase::endExtPayload(uint16_t start, int8_t extType)
 {
-    if(dataSize > 0)
+    uint32_t length = bufferPos - (start + 3);
+    uint8_t hdr = length <= 0xff ? 3 : (length <= 0xffff ? 4 : 6);
+    if(hdr > 3)
+        memmove(buffer+start+hdr,buffer+start+3,length);
+    bufferPos = start;
+    if(hdr == 3)
     {
-        if(dataSize < 16)
-        {
-            *(buffer+(bufferPos++)) = 0x90 + dataSize;
-        }
-        else
-        {
-            *(buffer+(bufferPos++)) = 0xdc;
-            *(buffer+(bufferPos++)) = 0x00;
-            *(buffer+(bufferPos++)) = dataSize;
-        }
-        for(int i=0;i<dataSize;i++)
-            serializeInteger(data[i]);
+        *(buffer+(bufferPos++)) = 0xc7;
+        *(buffer+(bufferPos++)) = length;
+    }
+    else if(hdr == 4)
+    {
+        *(buffer+(bufferPos++)) = 0xc8;
+        *(buffer+(bufferPos++)) = length >> 8;
+        *(buffer+(bufferPos++)) = length & 0xff;
     }
+    else
+    {
+        *(buffer+(bufferPos++)) = 0xc9;
+        *(buffer+(bufferPos++)) = length >> 24;
+        *(buffer+(bufferPos++)) = (length >> 16) & 0xff;
+        *(buffer+(bufferPos++)) = (length >> 8) & 0xff;
+        *(buffer+(bufferPos++)) = length & 0xff;
+    }
+    *(buffer+(bufferPos++)) = extType;
+    bufferPos = bufferPos + length;
 }
 
 /**
-  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 8 bits con signo.
-  *  @param data        Arreglo de enteros de 8 bits con signo.
-  *  @param dataSize    Tamao del arreglo (hasta 256 elementos).
+  *  @brief Serializa y escribe en el buffer una serie de nmeros de punto flotante
+  *         comprimida con el formato ext (tipo MSGPACK_EXT_FLOAT_SERIES), con el esquema
+  *         XOR de Gorilla. Los datos se componen del nmero de elementos (2 bytes), el
+  *         primer valor (32 bits) y, por cada valor siguiente, el XOR con el anterior:
+  *         '0' si es igual; '10' y los bits significativos si caben en la ventana de ceros
+  *         del valor anterior; '11', los ceros a la izquierda (5 bits), el nmero de bits
+  *         significativos menos 1 (5 bits) y los bits significativos en caso contrario.
+  *         Las seales que cambian poco ocupan unos pocos bits por valor.
+  *  @param data        Arreglo de nmeros de punto flotante.
+  *  @param dataSize    Tamao del arreglo.
   *  @return none
   */
-void MsgPackMap::serializeIntegerArray(int8_t data[],uint8_t dataSize)
+void MsgPackMapBase::serializeFloatSeries(const float data[], uint16_t dataSize)
 {
-    if(dataSize > 0)
+    uint16_t start = bufferPos;
+    uint32_t bitPos = 0;
+    uint32_t prev = 0;
+    uint8_t prevLeading = 0xff;
+    uint8_t prevTrailing = 0;
+    bufferPos = start + 3;
+    *(buffer+(bufferPos++)) = dataSize >> 8;
+    *(buffer+(bufferPos++)) = dataSize & 0xff;
+    byte *bits = buffer+bufferPos;
+    for(uint16_t i=0;i<dataSize;i++)
     {
-        if(dataSize < 16)
+        uint32_t value;
+        memcpy(&value,&data[i],sizeof(value));
+        if(i == 0)
+        {
+            writeBits(bits,bitPos,value,32);
+            prev = value;
+            continue;
+        }
+        uint32_t diff = value ^ prev;
+        prev = value;
+        if(diff == 0)
+        {
+            writeBits(bits,bitPos,0,1);
+            continue;
+        }
+        uint8_t leading = 0;
+        uint8_t trailing = 0;
+        while(leading < 31 && !(diff & ((uint32_t)0x80000000 >> leading)))
+            leading++;
+        while(!(diff & ((uint32_t)1 << trailing)))
+            trailing++;
+        if(prevLeading != 0xff && leading >= prevLeading && trailing >= prevTrailing)
         {
-            *(buffer+(bufferPos++)) = 0x90 + dataSize;
+            writeBits(bits,bitPos,2,2);
+            writeBits(bits,bitPos,diff >> prevTrailing,32 - prevLeading - prevTrailing);
         }
         else
         {
-            *(buffer+(bufferPos++)) = 0xdc;
-            *(buffer+(bufferPos++)) = 0x00;
-            *(buffer+(bufferPos++)) = dataSize;
+            uint8_t meaningful = 32 - leading - trailing;
+            writeBits(bits,bitPos,3,2);
+            writeBits(bits,bitPos,leading,5);
+            writeBits(bits,bitPos,meaningful - 1,5);
+            writeBits(bits,bitPos,diff >> trailing,meaningful);
+            prevLeading = leading;
+            prevTrailing = trailing;
         }
-        for(int i=0;i<dataSize;i++)
-            serializeInteger(data[i]);
     }
+    bufferPos = bufferPos + (bitPos + 7)/8;
+    endExtPayload(start,MSGPACK_EXT_FLOAT_SERIES);
 }
 
 /**
-  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 16 bits con signo.
-  *  @param data        Arreglo de enteros de 16 bits con signo.
-  *  @param dataSize    Tamao del arreglo (hasta 256 elementos).
+  *  @brief Escribe los bits menos significativos de value en un flujo de bits, del ms
+  *         significativo al menos significativo.
+  *  @param bits        Direccin del flujo de bits.
+  *  @param bitPos      Posicin del siguiente bit, se incrementa en count.
+  *  @param value       Valor a escribir.
+  *  @param count       Nmero de bits (hasta 32).
   *  @return none
   */
-void MsgPackMap::serializeIntegerArray(int16_t data[],uint8_t dataSize)
+void MsgPackMapBase::writeBits(byte bits[], uint32_t &bitPos, uint32_t value, uint8_t count)
 {
-    if(dataSize > 0)
+    while(count > 0)
     {
-        if(dataSize < 16)
-        {
-            *(buffer+(bufferPos++)) = 0x90 + dataSize;
-        }
-        else
-        {
-            *(buffer+(bufferPos++)) = 0xdc;
-            *(buffer+(bufferPos++)) = 0x00;
-            *(buffer+(bufferPos++)) = dataSize;
-        }
-        for(int i=0;i<dataSize;i++)
-            serializeInteger(data[i]);
+        uint8_t offset = bitPos & 7;
+        uint8_t n = 8 - offset < count ? 8 - offset : count;
+        byte chunk = (value >> (count - n)) & (0xff >> (8 - n));
+        if(offset == 0)
+            bits[bitPos >> 3] = 0;
+        bits[bitPos >> 3] |= chunk << (8 - offset - n);
+        bitPos = bitPos + n;
+        count = count - n;
     }
 }
 
 /**
-  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 32 bits con signo.
-  *  @param data        Arreglo de enteros de 32 bits con signo.
-  *  @param dataSize    Tamao del arreglo (hasta 256 elementos).
-  *  @return none
+  *  @brief Lee un entero de la memoria con el tamao y signo de su tipo.
+  *  @param data        Direccin del entero.
+  *  @param type        Tipo del entero (MSGPACK_FIELD_*).
+  *  @return int64_t    Valor del entero (un uint 64 conserva sus bits).
   */
-void MsgPackMap::serializeIntegerArray(int32_t data[],uint8_t dataSize)
+int64_t MsgPackMapBase::loadInteger(const byte data[], uint8_t type)
 {
-    if(dataSize > 0)
+    switch(type)
     {
-        if(dataSize < 16)
+        case MSGPACK_FIELD_UINT8:
+            return *data;
+        case MSGPACK_FIELD_INT8:
+            return (int8_t)*data;
+        case MSGPACK_FIELD_UINT16:
         {
-            *(buffer+(bufferPos++)) = 0x90 + dataSize;
+            uint16_t tmp;
+            memcpy(&tmp,data,sizeof(tmp));
+            return tmp;
         }
-        else
+        case MSGPACK_FIELD_INT16:
+        {
+            int16_t tmp;
+            memcpy(&tmp,data,sizeof(tmp));
+            return tmp;
+        }
+        case MSGPACK_FIELD_UINT32:
         {
-            *(buffer+(bufferPos++)) = 0xdc;
-            *(buffer+(bufferPos++)) = 0x00;
-            *(buffer+(bufferPos++)) = dataSize;
+            uint32_t tmp;
+            memcpy(&tmp,data,sizeof(tmp));
+            return tmp;
+        }
+        case MSGPACK_FIELD_INT32:
+        {
+            int32_t tmp;
+            memcpy(&tmp,data,sizeof(tmp));
+            return tmp;
+        }
+        case MSGPACK_FIELD_UINT64:
+        case MSGPACK_FIELD_INT64:
+        {
+            int64_t tmp;
+            memcpy(&tmp,data,sizeof(tmp));
+            return tmp;
         }
-        for(int i=0;i<dataSize;i++)
-            serializeInteger(data[i]);
     }
+    return 0;
 }
 
-/*********************************************************************
-  *
-  *  Mtodos auxiliares para bsqueda
-  *
-  ********************************************************************/
-
-
 /**
-  *  @brief Compara una cadena dada con una cadena serializada dentro de la estructura.
-  *  @param pos         Posicin inicial de la cadena serializada.
-  *  @param keyStr      Cadena de caracteres a comparar.
-  *  @return bool       Booleano que indica si las cadenas son iguales o no.
+  *  @brief Escribe un entero en la memoria con el tamao de su tipo.
+  *  @param data        Direccin del entero.
+  *  @param type        Tipo del entero (MSGPACK_FIELD_*).
+  *  @param value       Valor del entero.
+  *  @return none
   */
-bool MsgPackMap::isEqual(uint8_t pos, const char keyStr[])
+void MsgPackMapBase::storeInteger(byte data[], uint8_t type, int64_t value)
 {
-    uint8_t tmp = strlen(keyStr);
-    uint8_t cnt = 0;
-    for(int i=0;i<tmp;i++,pos++)
+    switch(type)
     {
-        if(*(buffer+pos) == keyStr[i])
-            cnt++;
-        else
+        case MSGPACK_FIELD_UINT8:
+        case MSGPACK_FIELD_INT8:
+            *data = value;
+            break;
+        case MSGPACK_FIELD_UINT16:
+        case MSGPACK_FIELD_INT16:
+        {
+            uint16_t tmp = value;
+            memcpy(data,&tmp,sizeof(tmp));
+            break;
+        }
+        case MSGPACK_FIELD_UINT32:
+        case MSGPACK_FIELD_INT32:
+        {
+            uint32_t tmp = value;
+            memcpy(data,&tmp,sizeof(tmp));
+            break;
+        }
+        case MSGPACK_FIELD_UINT64:
+        case MSGPACK_FIELD_INT64:
+            memcpy(data,&value,sizeof(value));
             break;
     }
-    if(cnt == tmp)
-        return true;
-    else
-        return false;
 }
 
 /**
-  *  @brief Busca el valor de una clave y devuelve la posicin inicial de los datos si es que
-  *         la clave existe o -1 si no existe la clave.
-  *  @param keyStr      Cadena de caracteres con la clave a buscar.
-  *  @return int        Entero con la posicin de los datos si es que la clave existe, -1 si no
-  *                     existe la clave.
+  *  @brief Copia un arreglo de elementos invirtiendo el orden de los bytes de cada uno
+  *         (little endian <-> big endian). Con SSSE3 o NEON los bloques de 16 bytes se
+  *         convierten con una sola instruccin de permutacin; el resto se convierte con
+  *         un ciclo escalar por tamao, sin dependencias entre iteraciones y con arreglos
+  *         que no se traslapan (__restrict__), que el compilador tambin puede vectorizar.
+  *         La implementacin se elige en compilacin; MSGPACK_NO_SIMD fuerza la escalar.
+  *  @param dst         Arreglo destino.
+  *  @param src         Arreglo origen.
+  *  @param dataSize    Nmero de elementos.
+  *  @param size        Tamao de cada elemento en bytes (1, 2, 4 u 8).
+  *  @return none
   */
-int MsgPackMap::getDataPosition(const char keyStr[])
+void MsgPackMapBase::swapBytes(byte * __restrict__ dst, const byte * __restrict__ src, uint32_t dataSize, uint8_t size)
 {
-    int dataSize = strlen(keyStr);
-    uint16_t i=1;
-    if(dataSize<32)
+    if(size == 1)
     {
-        uint8_t charToSearch = 0xa0 + dataSize;
-        while(i<bufferSize)
-        {
-            if(*(buffer+i) == charToSearch)
-            {
-                if(isEqual(i+1,keyStr))
-                    return i+1+dataSize;
-                else
-                    i = i+1+dataSize;
-            }
-            else
-            {
-                i++;
-            }
-        }
+        memcpy(dst,src,dataSize);
+        return;
     }
+    size_t done = 0;
+    size_t bytes = (size_t)dataSize*size;
+#if defined(MSGPACK_SIMD_SSSE3)
+    __m128i mask;
+    if(size == 2)
+        mask = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+    else if(size == 4)
+        mask = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
     else
+        mask = _mm_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+    for(;done+16<=bytes;done+=16)
     {
-        while(i<bufferSize)
-        {
-            if(*(buffer+i) == 0xd9)
+        __m128i block = _mm_loadu_si128((const __m128i*)(src+done));
+        _mm_storeu_si128((__m128i*)(dst+done),_mm_shuffle_epi8(block,mask));
+    }
+#elif defined(MSGPACK_SIMD_NEON)
+    for(;done+16<=bytes;done+=16)
+    {
+        uint8x16_t block = vld1q_u8(src+done);
+        if(size == 2)
+            block = vrev16q_u8(block);
+        else if(size == 4)
+            block = vrev32q_u8(block);
+        else
+            block = vrev64q_u8(block);
+        vst1q_u8(dst+done,block);
+    }
+#endif
+    dst = dst + done;
+    src = src + done;
+    dataSize = (bytes - done)/size;
+    switch(size)
+    {
+        case 2:
+            for(size_t i=0;i<dataSize;i++)
             {
-                if(*(buffer+i+1) == bufferSize)
-                {
-                    if(isEqual(i+2,keyStr))
-                        return i+2+dataSize;
-                    else
-                        i=i+2+dataSize;
-                }
-                else
-                {
-                    i++;
-                }
+                dst[2*i] = src[2*i+1];
+                dst[2*i+1] = src[2*i];
             }
-        }
+            break;
+        case 4:
+            for(size_t i=0;i<dataSize;i++)
+            {
+                dst[4*i] = src[4*i+3];
+                dst[4*i+1] = src[4*i+2];
+                dst[4*i+2] = src[4*i+1];
+                dst[4*i+3] = src[4*i];
+            }
+            break;
+        case 8:
+            for(size_t i=0;i<dataSize;i++)
+                for(uint8_t j=0;j<8;j++)
+                    dst[8*i+j] = src[8*i+7-j];
+            break;
     }
-    return -1;
 }
 
 /**
-  *  @brief Busca una clave y devuelve true si se encuentra en la estructura o false si no se encuentra.
-  *  @param keyStr      Cadena de caracteres con la clave a buscar.
-  *  @return bool       True si la clave existe, false en caso contrario.
+  *  @brief Serializa y escribe en el buffer un arreglo de nmeros de punto flotante de 4 bytes.
+  *  @param data        Arreglo de nmeros de punto flotante.
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
   */
-bool MsgPackMap::isKeyAvailable(const char keyStr[])
+void MsgPackMapBase::serializeFloatArray(float data[],uint16_t dataSize)
 {
-    if(getDataPosition(keyStr) != -1)
-        return true;
-    return false;
+    serializeArrayHeader(dataSize);
+    // Cada elemento ocupa 5 bytes (0xca y el nmero en big endian)
+    byte * __restrict__ dst = buffer+bufferPos;
+    const byte * __restrict__ src = (const byte*)data;
+    for(size_t i=0;i<dataSize;i++)
+    {
+        dst[5*i] = 0xca;
+        dst[5*i+1] = src[4*i+3];
+        dst[5*i+2] = src[4*i+2];
+        dst[5*i+3] = src[4*i+1];
+        dst[5*i+4] = src[4*i];
+    }
+    bufferPos = bufferPos + 5*dataSize;
 }
 
-/*********************************************************************
-  *
-  *  Mtodos para deserializar los datos (msgpack format -> data)
-  *
-  ********************************************************************/
-
 /**
-  *  @brief Deserializa un dato de tipo float32.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @return float      Dato deserializado.
+  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 8 bits sin signo.
+  *  @param data        Arreglo de enteros de 8 bits sin signo.
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
   */
-float MsgPackMap::deserializeFloat(int pos)
+void MsgPackMapBase::serializeIntegerArray(uint8_t data[],uint16_t dataSize)
 {
-    dec.numBytes[3] = *(buffer+pos);
-    dec.numBytes[2] = *(buffer+pos+1);
-    dec.numBytes[1] = *(buffer+pos+2);
-    dec.numBytes[0] = *(buffer+pos+3);
-    return dec.num;
+    serializeArrayHeader(dataSize);
+    for(int i=0;i<dataSize;i++)
+        serializeInteger(data[i]);
 }
 
 /**
-  *  @brief Deserializa un dato de tipo uint8.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @return float      Dato deserializado.
+  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 16 bits sin signo.
+  *  @param data        Arreglo de enteros de 16 bits sin signo.
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
   */
-uint8_t MsgPackMap::deserializeUnsignedInt8(int pos)
+void MsgPackMapBase::serializeIntegerArray(uint16_t data[],uint16_t dataSize)
 {
-    return *(buffer+pos);
+    serializeArrayHeader(dataSize);
+    for(int i=0;i<dataSize;i++)
+        serializeInteger(data[i]);
 }
 
 /**
-  *  @brief Deserializa un dato de tipo uint16.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @return float      Dato deserializado.
+  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 32 bits.
+  *  @param data        Arreglo de enteros de 32 bits.
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
   */
-uint16_t MsgPackMap::deserializeUnsignedInt16(int pos)
+void MsgPackMapBase::serializeIntegerArray(uint32_t data[],uint16_t dataSize)
 {
-    union num
-    {
-        uint16_t num;
-        byte raw[2];
-    } tmp;
-    tmp.raw[1] = *(buffer+pos);
-    tmp.raw[0] = *(buffer+pos+1);
-    return tmp.num;
+    serializeArrayHeader(dataSize);
+    for(int i=0;i<dataSize;i++)
+        serializeInteger(data[i]);
 }
 
 /**
-  *  @brief Deserializa un dato de tipo uint32.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @return float      Dato deserializado.
+  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 8 bits con signo.
+  *  @param data        Arreglo de enteros de 8 bits con signo.
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
   */
-uint32_t MsgPackMap::deserializeUnsignedInt32(int pos)
+void MsgPackMapBase::serializeIntegerArray(int8_t data[],uint16_t dataSize)
 {
-    union num
-    {
-        uint32_t num;
-        byte raw[4];
-    } tmp;
-    tmp.raw[3] = *(buffer+pos);
-    tmp.raw[2] = *(buffer+pos+1);
-    tmp.raw[1] = *(buffer+pos+2);
-    tmp.raw[0] = *(buffer+pos+3);
-    return tmp.num;
+    serializeArrayHeader(dataSize);
+    for(int i=0;i<dataSize;i++)
+        serializeInteger(data[i]);
 }
 
 /**
-  *  @brief Deserializa un dato de tipo int8.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @return float      Dato deserializado.
+  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 16 bits con signo.
+  *  @param data        Arreglo de enteros de 16 bits con signo.
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
   */
-int8_t MsgPackMap::deserializeInt8(int pos)
+void MsgPackMapBase::serializeIntegerArray(int16_t data[],uint16_t dataSize)
 {
-    return *(buffer+pos);
+    serializeArrayHeader(dataSize);
+    for(int i=0;i<dataSize;i++)
+        serializeInteger(data[i]);
 }
 
 /**
-  *  @brief Deserializa un dato de tipo int16.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @return float      Dato deserializado.
+  *  @brief Serializa y escribe en el buffer un arreglo de enteros de 32 bits con signo.
+  *  @param data        Arreglo de enteros de 32 bits con signo.
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
   */
-int16_t MsgPackMap::deserializeInt16(int pos)
+void MsgPackMapBase::serializeIntegerArray(int32_t data[],uint16_t dataSize)
 {
-    union num
-    {
-        int16_t num;
-        byte raw[2];
-    } tmp;
-    tmp.raw[1] = *(buffer+pos);
-    tmp.raw[0] = *(buffer+pos+1);
-    return tmp.num;
+    serializeArrayHeader(dataSize);
+    for(int i=0;i<dataSize;i++)
+        serializeInteger(data[i]);
 }
 
 /**
-  *  @brief Deserializa un dato de tipo int32.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @return float      Dato deserializado.
+  *  @brief Serializa y escribe en el buffer el valor de un miembro de una estructura.
+  *  @param data        Direccin de memoria de la estructura.
+  *  @param field       Descriptor del miembro.
+  *  @return none
   */
-int32_t MsgPackMap::deserializeInt32(int pos)
+void MsgPackMapBase::serializeField(const byte data[], const MsgPackField &field)
 {
-    union num
+    const byte *member = data + field.offset;
+    switch(field.type)
     {
-        int32_t num;
-        byte raw[4];
-    } tmp;
-    tmp.raw[3] = *(buffer+pos);
-    tmp.raw[2] = *(buffer+pos+1);
-    tmp.raw[1] = *(buffer+pos+2);
-    tmp.raw[0] = *(buffer+pos+3);
-    return tmp.num;
+        case MSGPACK_FIELD_UINT8:
+            serializeInteger(*member);
+            break;
+        case MSGPACK_FIELD_UINT16:
+        {
+            uint16_t tmp;
+            memcpy(&tmp,member,sizeof(tmp));
+            serializeInteger(tmp);
+            break;
+        }
+        case MSGPACK_FIELD_UINT32:
+        {
+            uint32_t tmp;
+            memcpy(&tmp,member,sizeof(tmp));
+            serializeInteger(tmp);
+            break;
+        }
+        case MSGPACK_FIELD_INT8:
+            serializeInteger((int8_t)*member);
+            break;
+        case MSGPACK_FIELD_INT16:
+        {
+            int16_t tmp;
+            memcpy(&tmp,member,sizeof(tmp));
+            serializeInteger(tmp);
+            break;
+        }
+        case MSGPACK_FIELD_INT32:
+        {
+            int32_t tmp;
+            memcpy(&tmp,member,sizeof(tmp));
+            serializeInteger(tmp);
+            break;
+        }
+        case MSGPACK_FIELD_UINT64:
+        {
+            uint64_t tmp;
+            memcpy(&tmp,member,sizeof(tmp));
+            serializeInteger(tmp);
+            break;
+        }
+        case MSGPACK_FIELD_INT64:
+        {
+            int64_t tmp;
+            memcpy(&tmp,member,sizeof(tmp));
+            serializeInteger(tmp);
+            break;
+        }
+        case MSGPACK_FIELD_FLOAT:
+        {
+            float tmp;
+            memcpy(&tmp,member,sizeof(tmp));
+            serializeFloat(tmp);
+            break;
+        }
+        case MSGPACK_FIELD_DOUBLE:
+        {
+            double tmp;
+            memcpy(&tmp,member,sizeof(tmp));
+            serializeDouble(tmp);
+            break;
+        }
+        case MSGPACK_FIELD_BOOL:
+            serializeBool(*member != 0);
+            break;
+        case MSGPACK_FIELD_STRING:
+        {
+            const byte *end = (const byte*)memchr(member,'\0',field.size);
+            serializeString((const char*)member,end != NULL ? end - member : field.size);
+            break;
+        }
+    }
 }
 
+/*********************************************************************
+  *
+  *  Mtodos auxiliares para bsqueda
+  *
+  ********************************************************************/
+
+
 /**
-  *  @brief Deserializa un dato de tipo string.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @return float      Dato deserializado.
+  *  @brief Compara una cadena dada con una cadena serializada dentro de la estructura.
+  *  @param pos         Posicin inicial de la cadena serializada.
+  *  @param key         Cadena de caracteres a comparar.
+  *  @return bool       Booleano que indica si las cadenas son iguales o no.
   */
-String MsgPackMap::deserializeString(int pos)
+bool MsgPackMapBase::isEqual(uint16_t pos, const MsgPackKey &key)
 {
-    uint8_t dataSize;
-    String tmp = "";
-    int ini;
-    if(*(buffer+pos) >= 0xa0 && *(buffer+pos) <= 0xbf)
-    {
-        dataSize = 0x1f & *(buffer+pos);
-        ini=pos+1;
-    }
-    else //if(*(buffer+pos) == 0xd9)
-    {
-        dataSize = *(buffer+pos+1);
-        ini=pos+2;
-    }
-    for(int i = ini;i<ini+dataSize;i++)
-        tmp += (char)*(buffer+i);
-    return tmp;
+    if((uint32_t)pos + key.length > getDataEnd())
+        return false;
+    return memcmp(buffer+pos,key.str,key.length) == 0;
 }
 
 /**
-  *  @brief Deserializa un conjunto de bytes.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @param buf         Buffer donde se almacenan los datos.
-  *  @param bufSize     Tamao del buffer.
-  *  @return none
+  *  @brief Busca el valor de una clave y devuelve la posicin inicial de los datos si es que
+  *         la clave existe o -1 si no existe la clave.
+  *  @param key         Clave a buscar.
+  *  @return int        Entero con la posicin de los datos si es que la clave existe, -1 si no
+  *                     existe la clave.
   */
-void MsgPackMap::deserializeByte(int pos, byte buf[], uint8_t bufSize)
+int MsgPackMapBase::getDataPosition(const MsgPackKey &key)
 {
-    uint8_t dataSize = *(buffer+pos);
-    uint8_t lim;
-    int j;
-    if(bufSize < dataSize)
-        lim = bufSize;
-    else
-        lim = dataSize;
-    for(int i=pos+1, j=0;i<pos+1+lim;i++,j++)
-        buf[j] = *(buffer+i);
+    if(index != NULL)
+        return getIndexedPosition(key,-1);
+    int16_t id = keyId(key);
+    if(id != -1)
+    {
+        // Un ndice no se distingue de un entero en el buffer: se recorre la estructura
+        int pos = 0;
+        return searchKey(pos,key,id,0);
+    }
+    if(!readCursor)
+        return scanKey(key,1,getDataEnd());
+    // Con el cursor de lectura se busca primero despus del ltimo valor encontrado y
+    // solo si la clave no est ah se vuelve al inicio de la estructura
+    int pos = scanKey(key,cursorPos,getDataEnd());
+    if(pos == -1 && cursorPos > 1)
+        pos = scanKey(key,1,cursorPos);
+    return pos;
 }
 
 /**
-  *  @brief Deserializa un arreglo de dloat.
-  *  @param pos         Posicin inicial del stream de datos.
-  *  @param buf         Buffer donde se almacenan los datos.
-  *  @param bufSize     Tamao del buffer.
-  *  @return none
+  *  @brief Busca la cabecera de una clave (fix str o str 8 con su tamao) seguida de sus
+  *         caracteres a partir de una posicin del buffer. La clave y su valor deben estar
+  *         completos dentro de los datos; una coincidencia cuyo valor no es vlido (p. ej.
+  *         bytes dentro de una cadena) se descarta y la bsqueda contina. Si el cursor de lectura est activo se actualiza
+  *         con el fin del valor encontrado.
+  *  @param key         Clave a buscar.
+  *  @param from        Posicin inicial de la bsqueda.
+  *  @param to          Posicin final (no incluida) de la cabecera de la clave.
+  *  @return int        Posicin de los datos si la clave existe, -1 si no existe.
   */
-void MsgPackMap::deserializeFloatArray(int pos, float buf[], uint8_t bufSize)
+int MsgPackMapBase::scanKey(const MsgPackKey &key, uint16_t from, uint16_t to)
 {
-    uint8_t dataSize, ini, lim,j;
-    if(*(buffer+pos) >= 0x90 && *(buffer+pos) <= 0x9f)
-    {
-        dataSize = 0x0f & *(buffer+pos);
-        ini = pos+1;
-    }
-    else
-    {
-        dataSize = *(buffer+pos+1);
-        ini = pos + 2;
-    }
-    if(bufSize < dataSize)
-        lim = bufSize*5;
-    else
-        lim = dataSize*5;
-    for(int i=ini,j=0;i<ini+lim;i=i+5,j++)
+    uint32_t end = getDataEnd();
+    uint8_t hdr = keyHeaderSize(key);
+    uint32_t i = from > 0 ? from : 1;
+    while(i < to && i + hdr + key.length < end)
     {
-        if(*(buffer+i) == 0xca)
-            buf[j]=deserializeFloat(i+1);
-        else
-            buf[j] = 0.0;
+        if(*(buffer+i) == key.header && (hdr == 1 || (hdr == 2 && *(buffer+i+1) == key.length) ||
+           (hdr == 3 && *(buffer+i+1) == (key.length >> 8) && *(buffer+i+2) == (key.length & 0xff))))
+        {
+            if(isEqual(i+hdr,key))
+            {
+                int pos = i + hdr + key.length;
+                int next = skipElement(pos);
+                if(next != -1)
+                {
+                    if(readCursor)
+                        cursorPos = next;
+                    return pos;
+                }
+            }
+        }
+        i++;
     }
+    return -1;
 }
 
-
-/*********************************************************************
-  *
-  *  Mtodos para agregar elementos al buffer y a la estructura del Map.
-  *  Los elementos se componen de par clave-valor.
-  *  La clave (key) debe ser forzozamente un elemento de tipo cadena.
-  *
-  ********************************************************************/
+/**
+  *  @brief Devuelve el tamao de la cabecera con la que se serializa una clave de texto
+  *         (fix str, str 8 o str 16).
+  *  @param key         Clave.
+  *  @return uint8_t    Tamao de la cabecera en bytes.
+  */
+uint8_t MsgPackMapBase::keyHeaderSize(const MsgPackKey &key)
+{
+    return key.header == 0xda ? 3 : (key.header == 0xd9 ? 2 : 1);
+}
 
 /**
-  *  @brief Inicializa la estructura del mapa.
-  *  @return none
+  *  @brief Busca una clave y devuelve true si se encuentra en la estructura o false si no se encuentra.
+  *  @param key         Cadena de caracteres con la clave a buscar.
+  *  @return bool       True si la clave existe, false en caso contrario.
   */
-void MsgPackMap::beginMap()
+bool MsgPackMapBase::isKeyAvailable(const MsgPackKey &key)
 {
-    numElements = 0;
-    startPos = 0;
-    bufferPos = 0;
-    level = 0;
-    startPos = bufferPos++;
+    if(getDataPosition(key) != -1)
+        return true;
+    return false;
 }
 
 /**
-  *  @brief Decreta el inicio de un submapa. Un elemento del mapa puede tener
-  *         como valor un submapa. La cantidad mxima de submapas anidados
-  *         (submapas dentro de un mismo submapa) o niveles se define por el
-  *         valor de la constante MAX_SUBMAPS.
-  *  @param keyStr      Cadena que representa la clave asociada al submapa.
-  *  @return none
+  *  @brief Busca una clave nicamente entre los elementos de un mapa. Los valores de los
+  *         elementos que no coinciden se saltan completos (ver skipElement()), por lo que
+  *         las claves de los submapas no se consideran. Si existe un ndice (ver
+  *         buildIndex()) se utiliza en lugar de recorrer el mapa.
+  *  @param mapPos      Posicin de la cabecera del mapa.
+  *  @param key         Clave a buscar.
+  *  @return int        Posicin de los datos si la clave existe en el mapa, -1 si no existe
+  *                     o si el elemento en mapPos no es un mapa.
   */
-void MsgPackMap::beginSubMap(const char keyStr[])
+int MsgPackMapBase::findKey(int mapPos, const MsgPackKey &key)
 {
-    static uint16_t tmp;
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        tmp = bufferPos++;
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        tmp = bufferPos++;
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
+    uint32_t payload, children;
+    if(mapPos < 0 || mapPos >= getDataEnd())
+        return -1;
+    byte tag = *(buffer+mapPos);
+    if((tag & 0xf0) != 0x80 && tag != 0xde && tag != 0xdf)
+        return -1;
+    if(mapPos + headerSize(tag) > getDataEnd())
+        return -1;
+    if(index != NULL)
+        return getIndexedPosition(key,mapPos);
+    elementSize(buffer+mapPos,payload,children);
+    int16_t id = keyId(key);
+    int pos = mapPos + headerSize(tag);
+    for(uint32_t i=0;i<children;i+=2)
     {
-        serializeString(keyStr);
-        tmp = bufferPos++;
-        *(buffer+(startPos + 2)) = ++numElements;
+        // La clave y el valor se validan antes de compararlos
+        int value = skipElement(pos);
+        int next = skipElement(value);
+        if(next == -1)
+            return -1;
+        if(matchKey(pos,key,id))
+            return value;
+        pos = next;
     }
-    positions[level] = startPos;
-    elements[level] = numElements;
-    startPos = tmp;
-    numElements = 0;
-    level++;
+    return -1;
 }
 
 /**
-  *  @brief Decreta el fin de un submapa. Es imperativo llamar a la funcin para indicar
-  *         que los siguientes elementos que se agreguen no pertenecen al submapa
-  *  @return none
+  *  @brief Indica si el elemento en pos es la clave indicada, ya sea como cadena o como
+  *         ndice del diccionario.
+  *  @param pos         Posicin del elemento.
+  *  @param key         Clave a comparar.
+  *  @param id          ndice de la clave en el diccionario, -1 si no pertenece a l.
+  *  @return bool       True si el elemento es la clave, false en caso contrario.
   */
-void MsgPackMap::endSubMap()
+bool MsgPackMapBase::matchKey(int pos, const MsgPackKey &key, int16_t id)
 {
-    level--;
-    startPos = positions[level];
-    numElements = elements[level];
+    uint16_t ini, keySize;
+    byte tag = *(buffer+pos);
+    if(tag < 0x80)
+        return tag == id;
+    return getStringData(pos,ini,keySize) && keySize == key.length && isEqual(ini,key);
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Entero sin signo de 8 bits.
-  *  @return none
+  *  @brief Busca una clave en un elemento y en los mapas y arreglos que contiene, en el
+  *         orden en que se encuentran en el buffer.
+  *  @param pos         Posicin inicial del elemento. Al terminar contiene la posicin
+  *                     siguiente al elemento, -1 si la estructura no es vlida.
+  *  @param key         Clave a buscar.
+  *  @param id          ndice de la clave en el diccionario, -1 si no pertenece a l.
+  *  @param depth       Nivel de anidamiento del elemento.
+  *  @return int        Posicin de los datos si la clave existe, -1 si no existe.
   */
-void MsgPackMap::addInteger(const char keyStr[],uint8_t data)
+int MsgPackMapBase::searchKey(int &pos, const MsgPackKey &key, int16_t id, uint8_t depth)
 {
-    if(numElements < 15)
+    uint32_t payload, children;
+    if(pos < 0 || pos >= getDataEnd())
     {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+startPos) = 0x80 | ++numElements;
+        pos = -1;
+        return -1;
     }
-    else if(numElements == 15)
+    byte tag = *(buffer+pos);
+    bool isMap = (tag & 0xf0) == 0x80 || tag == 0xde || tag == 0xdf;
+    bool isArray = (tag & 0xf0) == 0x90 || tag == 0xdc || tag == 0xdd;
+    if((!isMap && !isArray) || depth > maxDepth || pos + headerSize(tag) > getDataEnd())
     {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos + 2;
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        pos = skipElement(pos);
+        return -1;
     }
-    else
+    elementSize(buffer+pos,payload,children);
+    pos = pos + headerSize(tag);
+    for(uint32_t i=0;i<children;i++)
     {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        if(isMap)
+        {
+            int value = skipElement(pos);
+            if(value == -1 || skipElement(value) == -1)
+            {
+                pos = -1;
+                return -1;
+            }
+            if(matchKey(pos,key,id))
+                return value;
+            pos = value;
+            i++;
+        }
+        int found = searchKey(pos,key,id,depth+1);
+        if(found != -1 || pos == -1)
+            return found;
     }
+    return -1;
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Entero sin signo de 16 bits.
-  *  @return none
+  *  @brief Busca el valor indicado por una ruta de claves separadas por punto (por ejemplo
+  *         "imu.accel.x"). Cada clave se busca solo dentro del submapa encontrado con la
+  *         clave anterior, iniciando por el mapa principal.
+  *  @param path        Ruta de claves separadas por '.'.
+  *  @return int        Posicin de los datos si la ruta existe, -1 si no existe.
   */
-void MsgPackMap::addInteger(const char keyStr[],uint16_t data)
+int MsgPackMapBase::getPathPosition(const char path[])
 {
-    if(numElements < 15)
+    int pos = 0;
+    const char *segment = path;
+    while(true)
     {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+startPos) = 0x80 | ++numElements;
+        const char *end = strchr(segment,'.');
+        uint16_t length = end != NULL ? end - segment : strlen(segment);
+        pos = findKey(pos,MsgPackKey(segment,length));
+        if(pos == -1 || end == NULL)
+            return pos;
+        segment = end + 1;
     }
-    else if(numElements == 15)
+}
+
+/**
+  *  @brief Busca una ruta de claves separadas por punto (ver getPathPosition()) y devuelve
+  *         true si existe en la estructura o false si no existe.
+  *  @param path        Ruta de claves separadas por '.'.
+  *  @return bool       True si la ruta existe, false en caso contrario.
+  */
+bool MsgPackMapBase::isPathAvailable(const char path[])
+{
+    return getPathPosition(path) != -1;
+}
+
+/*********************************************************************
+  *
+  *  Mtodos para el ndice de claves. El ndice se construye una sola vez
+  *  despus de recibir la estructura y permite localizar el valor de una
+  *  clave sin recorrer el buffer byte por byte.
+  *
+  ********************************************************************/
+
+/**
+  *  @brief Construye un ndice con las claves de la estructura. El ndice se almacena en
+  *         el arreglo proporcionado y se ordena por hash, de manera que las lecturas
+  *         posteriores (read*, isKeyAvailable) realizan una bsqueda binaria en lugar de
+  *         recorrer el buffer. Se debe invocar despus de recibir la estructura y deja de
+  *         utilizarse al llamar a clearIndex(), clearData() o beginMap().
+  *  @param idx         Arreglo donde se almacenan las entradas del ndice.
+  *  @param idxSize     Nmero mximo de entradas (claves) del ndice.
+  *  @return bool       True si se construy el ndice, false si la estructura no es vlida
+  *                     o contiene ms claves que entradas disponibles.
+  */
+bool MsgPackMapBase::buildIndex(MsgPackIndexEntry idx[], uint8_t idxSize)
+{
+    index = idx;
+    indexCount = 0;
+    if(indexElement(0,0,idxSize,0) == -1)
     {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        clearIndex();
+        return false;
     }
-    else
+    // Ordenamiento por insercin: las claves con el mismo hash conservan el orden del buffer
+    for(int i=1;i<indexCount;i++)
     {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        MsgPackIndexEntry tmp = index[i];
+        int j = i-1;
+        while(j >= 0 && index[j].hash > tmp.hash)
+        {
+            index[j+1] = index[j];
+            j--;
+        }
+        index[j+1] = tmp;
     }
+    return true;
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Entero sin signo de 32 bits.
+  *  @brief Descarta el ndice de claves y regresa el cursor de lectura al inicio. Las
+  *         lecturas posteriores recorren el buffer.
   *  @return none
   */
-void MsgPackMap::addInteger(const char keyStr[],uint32_t data)
+void MsgPackMapBase::clearIndex()
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
-    {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+    index = NULL;
+    indexCount = 0;
+    cursorPos = 0;
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Entero con signo de 8 bits.
+  *  @brief Activa o desactiva el cursor de lectura. Con el cursor activo cada bsqueda por
+  *         clave empieza donde termin el valor de la anterior y vuelve al inicio solo si
+  *         no encuentra la clave, por lo que leer los valores en el mismo orden en que se
+  *         escribieron recorre la estructura una sola vez sin necesidad de un ndice. Si
+  *         una clave se repite (p. ej. en submapas) se devuelve la primera aparicin a
+  *         partir del cursor. No se utiliza con el ndice ni con el diccionario de claves.
+  *  @param enable      True para activar el cursor, false para desactivarlo.
   *  @return none
   */
-void MsgPackMap::addInteger(const char keyStr[],int8_t data)
+void MsgPackMapBase::setReadCursor(bool enable)
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
+    readCursor = enable;
+    cursorPos = 0;
+}
+
+/**
+  *  @brief Busca una clave en el ndice y devuelve la posicin de sus datos.
+  *  @param key         Cadena de caracteres con la clave a buscar.
+  *  @param parentPos   Posicin de la cabecera del mapa que debe contener la clave, -1
+  *                     para buscar en todos los mapas.
+  *  @return int        Posicin de los datos si la clave existe, -1 si no existe.
+  */
+int MsgPackMapBase::getIndexedPosition(const MsgPackKey &key, int parentPos)
+{
+    uint16_t dataSize = key.length;
+    uint16_t hash = keyHash(key);
+    int16_t id = keyId(key);
+    uint8_t low = 0;
+    uint8_t high = indexCount;
+    while(low < high)
     {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        uint8_t mid = (low + high)/2;
+        if(index[mid].hash < hash)
+            low = mid + 1;
+        else
+            high = mid;
     }
-    else
+    for(uint8_t i=low;i<indexCount && index[i].hash == hash;i++)
     {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        if(parentPos != -1 && index[i].parentPos != parentPos)
+            continue;
+        if(index[i].dataPos - index[i].keyPos == dataSize && isEqual(index[i].keyPos,key))
+            return index[i].dataPos;
+        // Las claves del diccionario se indexan con tamao 0, el ndice precede al valor
+        if(id != -1 && index[i].dataPos == index[i].keyPos && *(buffer+index[i].dataPos-1) == id)
+            return index[i].dataPos;
     }
+    return -1;
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Entero con signo de 16 bits.
-  *  @return none
+  *  @brief Recorre un elemento de la estructura y agrega al ndice las claves de tipo
+  *         cadena de los mapas que contiene (incluyendo submapas y mapas dentro de arreglos).
+  *  @param pos         Posicin inicial del elemento.
+  *  @param parentPos   Posicin de la cabecera del mapa que contiene al elemento.
+  *  @param idxSize     Nmero mximo de entradas del ndice.
+  *  @param depth       Nivel de anidamiento del elemento.
+  *  @return int        Posicin siguiente al elemento, -1 si la estructura no es vlida.
   */
-void MsgPackMap::addInteger(const char keyStr[],int16_t data)
+int MsgPackMapBase::indexElement(int pos, uint16_t parentPos, uint8_t idxSize, uint8_t depth)
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
+    uint32_t payload, children;
+    if(pos < 0 || pos >= getDataEnd())
+        return -1;
+    byte tag = *(buffer+pos);
+    uint8_t hdr = headerSize(tag);
+    if(hdr == 0 || pos+hdr > getDataEnd())
+        return -1;
+    elementSize(buffer+pos,payload,children);
+    bool isMap = (tag & 0xf0) == 0x80 || tag == 0xde || tag == 0xdf;
+    bool isArray = (tag & 0xf0) == 0x90 || tag == 0xdc || tag == 0xdd;
+    if(!isMap && !isArray)
+        return skipElement(pos);
+    if(depth > maxDepth)
+        return -1;
+    int next = pos + hdr;
+    for(uint32_t i=0;i<children;i++)
     {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
-    {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        if(isMap)
+        {
+            if(next >= getDataEnd())
+                return -1;
+            uint8_t keyHdr = headerSize(*(buffer+next));
+            bool isStr = (*(buffer+next) & 0xe0) == 0xa0 || (*(buffer+next) >= 0xd9 && *(buffer+next) <= 0xdb);
+            int keyEnd = skipElement(next);
+            if(keyEnd == -1)
+                return -1;
+            if(isStr)
+            {
+                if(indexCount >= idxSize)
+                    return -1;
+                index[indexCount].keyPos = next + keyHdr;
+                index[indexCount].dataPos = keyEnd;
+                index[indexCount].parentPos = pos;
+                index[indexCount].hash = hashKey(buffer+next+keyHdr,keyEnd-next-keyHdr);
+                indexCount++;
+            }
+            else if(*(buffer+next) < dictionarySize)
+            {
+                if(indexCount >= idxSize)
+                    return -1;
+                index[indexCount].keyPos = keyEnd;
+                index[indexCount].dataPos = keyEnd;
+                index[indexCount].parentPos = pos;
+                index[indexCount].hash = keyHash(dictionary[*(buffer+next)]);
+                indexCount++;
+            }
+            next = indexElement(keyEnd,pos,idxSize,depth+1);
+            i++;
+        }
+        else
+        {
+            next = indexElement(next,parentPos,idxSize,depth+1);
+        }
+        if(next == -1)
+            return -1;
     }
+    return next;
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Entero con signo de 32 bits.
+  *  @brief Calcula el hash (djb2 de 16 bits) de una clave.
+  *  @param data        Caracteres de la clave.
+  *  @param dataSize    Nmero de caracteres.
+  *  @return uint16_t   Hash de la clave.
+  */
+uint16_t MsgPackMapBase::hashKey(const byte data[], uint16_t dataSize)
+{
+    uint16_t hash = 5381;
+    for(uint16_t i=0;i<dataSize;i++)
+        hash = (hash << 5) + hash + data[i];
+    return hash;
+}
+
+/**
+  *  @brief Devuelve el hash de una clave: el calculado al construirla (claves literales) o,
+  *         si no se calcul, el de hashKey(). Las claves de longitud conocida no calculan
+  *         el hash al construirse, por lo que solo se calcula al utilizar el ndice, el
+  *         diccionario o un esquema.
+  *  @param key         Clave.
+  *  @return uint16_t   Hash de la clave.
+  */
+uint16_t MsgPackMapBase::keyHash(const MsgPackKey &key)
+{
+    return key.hashed ? key.hash : hashKey((const byte*)key.str,key.length);
+}
+
+/*********************************************************************
+  *
+  *  Mtodos para el diccionario de claves. Ambos extremos comparten una
+  *  tabla de claves y cada clave de la tabla se serializa como su ndice
+  *  (positive fixint, 1 byte) en lugar de la cadena completa.
+  *
+  ********************************************************************/
+
+/**
+  *  @brief Asigna el diccionario de claves. Las claves del diccionario se serializan como
+  *         su posicin en el arreglo (0 a 127) y las dems como cadena, por lo que el
+  *         receptor debe utilizar el mismo arreglo en el mismo orden. Las lecturas aceptan
+  *         ambas formas de la clave. Se debe invocar antes de buildIndex().
+  *  @param keys        Arreglo de claves, NULL para desactivar el diccionario. El arreglo
+  *                     debe existir mientras se utilice el mapa.
+  *  @param numKeys     Nmero de claves (se consideran hasta 128).
   *  @return none
   */
-void MsgPackMap::addInteger(const char keyStr[],int32_t data)
+void MsgPackMapBase::setKeyDictionary(const MsgPackKey keys[], uint8_t numKeys)
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
+    dictionary = keys;
+    dictionarySize = keys != NULL ? (numKeys < 128 ? numKeys : 128) : 0;
+}
+
+/**
+  *  @brief Busca una clave en el diccionario. Las claves se comparan primero por hash.
+  *  @param key         Clave a buscar.
+  *  @return int16_t    ndice de la clave, -1 si no existe o no hay diccionario.
+  */
+int16_t MsgPackMapBase::keyId(const MsgPackKey &key)
+{
+    if(dictionarySize == 0)
+        return -1;
+    uint16_t hash = keyHash(key);
+    for(uint8_t i=0;i<dictionarySize;i++)
     {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        if(keyHash(dictionary[i]) == hash && dictionary[i].length == key.length &&
+           memcmp(dictionary[i].str,key.str,key.length) == 0)
+            return i;
     }
-    else
+    return -1;
+}
+
+/**
+  *  @brief Devuelve la clave del diccionario serializada como ndice en pos.
+  *  @param pos         Posicin del elemento.
+  *  @return const MsgPackKey*  Clave del diccionario, NULL si el elemento no es un ndice
+  *                             del diccionario.
+  */
+const MsgPackKey *MsgPackMapBase::dictionaryKey(int pos)
+{
+    if(pos < 0 || pos >= getDataEnd() || *(buffer+pos) >= dictionarySize)
+        return NULL;
+    return &dictionary[*(buffer+pos)];
+}
+
+/*********************************************************************
+  *
+  *  Mtodos auxiliares para recorrer la estructura
+  *
+  ********************************************************************/
+
+/**
+  *  @brief Devuelve el tamao de la cabecera (tipo y longitud) de un elemento.
+  *  @param tag         Primer byte del elemento.
+  *  @return uint8_t    Tamao de la cabecera en bytes, 0 si el tipo no es vlido.
+  */
+uint8_t MsgPackMapBase::headerSize(byte tag)
+{
+    if(tag <= 0xbf || tag >= 0xe0)
+        return 1;
+    switch(tag)
     {
-        serializeString(keyStr);
-        serializeInteger(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        case 0xc1:
+            return 0;
+        case 0xc4: case 0xd9:
+        case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+            return 2;
+        case 0xc5: case 0xda: case 0xdc: case 0xde: case 0xc7:
+            return 3;
+        case 0xc8:
+            return 4;
+        case 0xc6: case 0xdb: case 0xdd: case 0xdf:
+            return 5;
+        case 0xc9:
+            return 6;
+        default:
+            return 1;
     }
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es de un nmero
-  *         de punto flotante de 4 bytes. Si la funcin se invoca inmediatamente
-  *         despus de iniciarse un submap, el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Nmero de punto flotante (4 bytes).
+  *  @brief Obtiene, a partir de la cabecera de un elemento, el nmero de bytes de datos
+  *         que le siguen y el nmero de elementos que contiene (arreglos y mapas; en los
+  *         mapas se cuentan claves y valores).
+  *  @param header      Cabecera completa del elemento (ver headerSize()).
+  *  @param payload     Nmero de bytes de datos posteriores a la cabecera.
+  *  @param children    Nmero de elementos contenidos.
   *  @return none
   */
-void MsgPackMap::addFloat(const char keyStr[],float data)
+void MsgPackMapBase::elementSize(const byte header[], uint32_t &payload, uint32_t &children)
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeFloat(data);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeFloat(data);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+    byte tag = header[0];
+    uint32_t len16 = 0, len32 = 0;
+    payload = 0;
+    children = 0;
+    if(tag <= 0x7f || tag >= 0xe0) //fixInt
+        return;
+    if(headerSize(tag) >= 3)
+        len16 = ((uint16_t)header[1] << 8) | header[2];
+    if(headerSize(tag) >= 5)
+        len32 = (len16 << 16) | ((uint16_t)header[3] << 8) | header[4];
+    if(tag <= 0x8f) //fixMap
+        children = 2*(tag & 0x0f);
+    else if(tag <= 0x9f) //fixArray
+        children = tag & 0x0f;
+    else if(tag <= 0xbf) //fixStr
+        payload = tag & 0x1f;
     else
     {
-        serializeString(keyStr);
-        serializeFloat(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        switch(tag)
+        {
+            case 0xc4: case 0xc7: case 0xd9: //bin8, ext8, str8
+                payload = header[1];
+                break;
+            case 0xc5: case 0xc8: case 0xda: //bin16, ext16, str16
+                payload = len16;
+                break;
+            case 0xc6: case 0xc9: case 0xdb: //bin32, ext32, str32
+                payload = len32;
+                break;
+            case 0xcc: case 0xd0: case 0xd4:
+                payload = 1;
+                break;
+            case 0xcd: case 0xd1: case 0xd5:
+                payload = 2;
+                break;
+            case 0xca: case 0xce: case 0xd2: case 0xd6:
+                payload = 4;
+                break;
+            case 0xcb: case 0xcf: case 0xd3: case 0xd7:
+                payload = 8;
+                break;
+            case 0xd8:
+                payload = 16;
+                break;
+            case 0xdc: //array16
+                children = len16;
+                break;
+            case 0xdd: //array32
+                children = len32;
+                break;
+            case 0xde: //map16
+                children = 2*len16;
+                break;
+            case 0xdf: //map32
+                children = len32 > 0x7fffffff ? 0xffffffff : 2*len32;
+                break;
+        }
     }
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es otra cadena de caracteres.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Cadena de caracteres de tamao mximo 256.
-  *  @return none
+  *  @brief Avanza sobre un elemento completo (incluyendo el contenido de arreglos y mapas)
+  *         sin deserializarlo.
+  *  @param pos         Posicin inicial del elemento.
+  *  @return int        Posicin siguiente al elemento, -1 si el elemento excede el buffer
+  *                     o no es vlido.
   */
-void MsgPackMap::addString(const char keyStr[],const char data[])
+int MsgPackMapBase::skipElement(int pos)
 {
-    if(numElements < 15)
+    uint32_t pending = 1;
+    uint32_t payload, children;
+    uint8_t hdr;
+    uint16_t end = getDataEnd();
+    while(pending > 0)
     {
-        serializeString(keyStr);
-        serializeString(data);
-        *(buffer+startPos) = 0x80 | ++numElements;
+        if(pos < 0 || pos >= end)
+            return -1;
+        hdr = headerSize(*(buffer+pos));
+        if(hdr == 0 || pos+hdr > end)
+            return -1;
+        elementSize(buffer+pos,payload,children);
+        if(payload > (uint32_t)(end-pos-hdr) || children > (uint32_t)(end-pos-hdr))
+            return -1;
+        pos = pos + hdr + payload;
+        pending = pending - 1 + children;
     }
-    else if(numElements == 15)
+    return pos;
+}
+
+/**
+  *  @brief Devuelve el fin de los datos que se pueden leer: la longitud del mensaje
+  *         asociado con attachData(), el tamao de la estructura si se construy con este
+  *         objeto o, en otro caso, el tamao del buffer. Las bsquedas y la validacin de
+  *         los elementos no leen ms all de esta posicin, por lo que su costo depende
+  *         del tamao del mensaje y no de la capacidad del buffer. Los datos recibidos se
+  *         deben asociar con attachData(); solo un objeto recin construido o limpiado con
+  *         clearData() lee hasta el tamao del buffer.
+  *  @return uint16_t   Posicin siguiente al ltimo byte vlido.
+  */
+uint16_t MsgPackMapBase::getDataEnd()
+{
+    return attached ? dataSize : (bufferPos > 0 ? bufferPos : bufferSize);
+}
+
+/*********************************************************************
+  *
+  *  Mtodos para deserializar los datos (msgpack format -> data)
+  *
+  ********************************************************************/
+
+/**
+  *  @brief Deserializa un dato de tipo float32.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return float      Dato deserializado.
+  */
+float MsgPackMapBase::deserializeFloat(int pos)
+{
+    dec.numBytes[3] = *(buffer+pos);
+    dec.numBytes[2] = *(buffer+pos+1);
+    dec.numBytes[1] = *(buffer+pos+2);
+    dec.numBytes[0] = *(buffer+pos+3);
+    return dec.num;
+}
+
+/**
+  *  @brief Deserializa un dato de tipo uint8.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return float      Dato deserializado.
+  */
+uint8_t MsgPackMapBase::deserializeUnsignedInt8(int pos)
+{
+    return *(buffer+pos);
+}
+
+/**
+  *  @brief Deserializa un dato de tipo uint16.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return float      Dato deserializado.
+  */
+uint16_t MsgPackMapBase::deserializeUnsignedInt16(int pos)
+{
+    union num
     {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeString(data);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
+        uint16_t num;
+        byte raw[2];
+    } tmp;
+    tmp.raw[1] = *(buffer+pos);
+    tmp.raw[0] = *(buffer+pos+1);
+    return tmp.num;
+}
+
+/**
+  *  @brief Deserializa un dato de tipo uint32.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return float      Dato deserializado.
+  */
+uint32_t MsgPackMapBase::deserializeUnsignedInt32(int pos)
+{
+    union num
     {
-        serializeString(keyStr);
-        serializeString(data);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+        uint32_t num;
+        byte raw[4];
+    } tmp;
+    tmp.raw[3] = *(buffer+pos);
+    tmp.raw[2] = *(buffer+pos+1);
+    tmp.raw[1] = *(buffer+pos+2);
+    tmp.raw[0] = *(buffer+pos+3);
+    return tmp.num;
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es de tipo bool.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. True o False (bool).
-  *  @return none
+  *  @brief Deserializa un dato de tipo int8.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return float      Dato deserializado.
+  */
+int8_t MsgPackMapBase::deserializeInt8(int pos)
+{
+    return *(buffer+pos);
+}
+
+/**
+  *  @brief Deserializa un dato de tipo int16.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return float      Dato deserializado.
   */
-void MsgPackMap::addBool(const char keyStr[],bool data)
+int16_t MsgPackMapBase::deserializeInt16(int pos)
 {
-    if(numElements < 15)
+    union num
     {
-        serializeString(keyStr);
-        serializeBool(data);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
+        int16_t num;
+        byte raw[2];
+    } tmp;
+    tmp.raw[1] = *(buffer+pos);
+    tmp.raw[0] = *(buffer+pos+1);
+    return tmp.num;
+}
+
+/**
+  *  @brief Deserializa un dato de tipo int32.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return float      Dato deserializado.
+  */
+int32_t MsgPackMapBase::deserializeInt32(int pos)
+{
+    union num
     {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeBool(data);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
+        int32_t num;
+        byte raw[4];
+    } tmp;
+    tmp.raw[3] = *(buffer+pos);
+    tmp.raw[2] = *(buffer+pos+1);
+    tmp.raw[1] = *(buffer+pos+2);
+    tmp.raw[0] = *(buffer+pos+3);
+    return tmp.num;
+}
+
+/**
+  *  @brief Deserializa un dato de tipo uint64.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return uint64_t   Dato deserializado.
+  */
+uint64_t MsgPackMapBase::deserializeUnsignedInt64(int pos)
+{
+    uint64_t tmp = 0;
+    for(int i=0;i<8;i++)
+        tmp = (tmp << 8) | *(buffer+pos+i);
+    return tmp;
+}
+
+/**
+  *  @brief Deserializa un dato de tipo int64.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return int64_t    Dato deserializado.
+  */
+int64_t MsgPackMapBase::deserializeInt64(int pos)
+{
+    return (int64_t)deserializeUnsignedInt64(pos);
+}
+
+/**
+  *  @brief Deserializa un dato de tipo float64. En las plataformas donde double es de
+  *         4 bytes (AVR) el valor se redondea a la precisin de float.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return double     Dato deserializado.
+  */
+double MsgPackMapBase::deserializeDouble(int pos)
+{
+    uint64_t bits = deserializeUnsignedInt64(pos);
+    if(sizeof(double) == 8)
     {
-        serializeString(keyStr);
-        serializeBool(data);
-        *(buffer+(startPos + 2)) = ++numElements;
+        double tmp;
+        memcpy(&tmp,&bits,sizeof(tmp));
+        return tmp;
     }
+    // Conversin de binary64 a binary32
+    uint32_t sign = (bits >> 32) & 0x80000000;
+    int16_t exponent = ((bits >> 52) & 0x7ff) - 1023 + 127;
+    uint64_t mantissa = bits & 0x000fffffffffffffULL;
+    uint32_t tmp;
+    if(((bits >> 52) & 0x7ff) == 0x7ff) //inf, NaN
+        tmp = sign | 0x7f800000 | (mantissa ? 0x400000 : 0);
+    else if(exponent >= 0xff)
+        tmp = sign | 0x7f800000;
+    else if(exponent <= 0)
+        tmp = sign;
+    else
+        tmp = sign | (((uint32_t)exponent << 23) + (uint32_t)((mantissa + (1ULL << 28)) >> 29));
+    float num;
+    memcpy(&num,&tmp,sizeof(num));
+    return num;
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es null.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @return none
+  *  @brief Obtiene la posicin y el tamao de los caracteres de una cadena serializada.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @param ini         Posicin del primer caracter de la cadena.
+  *  @param dataSize    Nmero de caracteres de la cadena.
+  *  @return bool       True si el dato es de tipo cadena, false en caso contrario.
   */
-void MsgPackMap::addNull(const char keyStr[])
+bool MsgPackMapBase::getStringData(int pos, uint16_t &ini, uint16_t &dataSize)
 {
-    if(numElements < 15)
+    if(*(buffer+pos) >= 0xa0 && *(buffer+pos) <= 0xbf) //fixStr
     {
-        serializeString(keyStr);
-        serializeNil();
-        *(buffer+startPos) = 0x80 | ++numElements;
+        dataSize = 0x1f & *(buffer+pos);
+        ini = pos+1;
+        return true;
     }
-    else if(numElements == 15)
+    else if(*(buffer+pos) == 0xd9) //str8
     {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeNil();
-        *(buffer+(startPos + 2)) = ++numElements;
+        dataSize = *(buffer+pos+1);
+        ini = pos+2;
+        return true;
     }
-    else
+    else if(*(buffer+pos) == 0xda) //str16
+    {
+        dataSize = deserializeUnsignedInt16(pos+1);
+        ini = pos+3;
+        return true;
+    }
+    else if(*(buffer+pos) == 0xdb) //str32
     {
-        serializeString(keyStr);
-        serializeNil();
-        *(buffer+(startPos + 2)) = ++numElements;
+        dataSize = deserializeUnsignedInt32(pos+1);
+        ini = pos+5;
+        return true;
     }
+    return false;
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es un arreglo de bytes.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Arreglo de bytes.
-  *  @param dataSize    Tamao del arreglo.
-  *  @return none
+  *  @brief Deserializa un dato de tipo string. La memoria de la cadena se reserva una
+  *         sola vez antes de copiar los caracteres.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @return String     Dato deserializado.
   */
-void MsgPackMap::addByte(const char keyStr[],byte data[],uint8_t dataSize)
+String MsgPackMapBase::deserializeString(int pos)
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeByte(data,dataSize);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeByte(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
+    uint16_t dataSize, ini;
+    String tmp = "";
+    if(getStringData(pos,ini,dataSize))
     {
-        serializeString(keyStr);
-        serializeByte(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
+        tmp.reserve(dataSize);
+        for(uint16_t i = ini;i<ini+dataSize;i++)
+            tmp += (char)*(buffer+i);
     }
+    return tmp;
+}
+
+/**
+  *  @brief Deserializa un conjunto de bytes (bin 8, bin 16 o bin 32).
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @param buf         Buffer donde se almacenan los datos.
+  *  @param bufSize     Tamao del buffer.
+  *  @return none
+  */
+void MsgPackMapBase::deserializeByte(int pos, byte buf[], uint16_t bufSize)
+{
+    uint32_t dataSize, children;
+    uint8_t hdr = headerSize(*(buffer+pos));
+    elementSize(buffer+pos,dataSize,children);
+    if(bufSize < dataSize)
+        dataSize = bufSize;
+    memcpy(buf,buffer+pos+hdr,dataSize);
+}
+
+/**
+  *  @brief Deserializa un arreglo de float. Cada elemento puede ser de tipo float 32,
+  *         float 64 o entero; los elementos de otro tipo se devuelven como 0.0.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @param buf         Buffer donde se almacenan los datos.
+  *  @param bufSize     Tamao del buffer.
+  *  @return none
+  */
+void MsgPackMapBase::deserializeFloatArray(int pos, float buf[], uint16_t bufSize)
+{
+    uint32_t payload, dataSize;
+    double tmp;
+    elementSize(buffer+pos,payload,dataSize);
+    pos = pos + headerSize(*(buffer+pos));
+    uint32_t count = dataSize < bufSize ? dataSize : bufSize;
+    // Caso comn: todos los elementos son float 32, con un paso fijo de 5 bytes
+    if((uint32_t)pos + 5*count <= getDataEnd())
+    {
+        uint32_t j = 0;
+        while(j < count && *(buffer+(pos + 5*j)) == 0xca)
+            j++;
+        if(j == count)
+        {
+            const byte * __restrict__ src = buffer+pos;
+            byte * __restrict__ dst = (byte*)buf;
+            for(size_t i=0;i<count;i++)
+            {
+                dst[4*i] = src[5*i+4];
+                dst[4*i+1] = src[5*i+3];
+                dst[4*i+2] = src[5*i+2];
+                dst[4*i+3] = src[5*i+1];
+            }
+            return;
+        }
+    }
+    for(uint32_t j=0;j<dataSize && j<bufSize && pos != -1;j++)
+    {
+        buf[j] = deserializeReal(pos,tmp) ? tmp : 0.0;
+        pos = skipElement(pos);
+    }
+}
+
+/**
+  *  @brief Deserializa un entero de cualquier formato (fix int, uint 8/16/32/64,
+  *         int 8/16/32/64). Los enteros uint 64 mayores a 2^63-1 conservan sus bits.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @param value       Dato deserializado.
+  *  @return bool       True si el dato es un entero, false en caso contrario.
+  */
+bool MsgPackMapBase::deserializeInteger(int pos, int64_t &value)
+{
+    byte tag = *(buffer+pos);
+    if(tag <= 0x7f || tag >= 0xe0) //fixInt
+    {
+        value = (int8_t)tag;
+        return true;
+    }
+    switch(tag)
+    {
+        case 0xcc:
+            value = deserializeUnsignedInt8(pos+1);
+            return true;
+        case 0xcd:
+            value = deserializeUnsignedInt16(pos+1);
+            return true;
+        case 0xce:
+            value = deserializeUnsignedInt32(pos+1);
+            return true;
+        case 0xcf:
+            value = deserializeUnsignedInt64(pos+1);
+            return true;
+        case 0xd0:
+            value = deserializeInt8(pos+1);
+            return true;
+        case 0xd1:
+            value = deserializeInt16(pos+1);
+            return true;
+        case 0xd2:
+            value = deserializeInt32(pos+1);
+            return true;
+        case 0xd3:
+            value = deserializeInt64(pos+1);
+            return true;
+    }
+    return false;
+}
+
+/**
+  *  @brief Deserializa un nmero de punto flotante (float 32 o float 64) o un entero
+  *         como double.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @param value       Dato deserializado.
+  *  @return bool       True si el dato es numrico, false en caso contrario.
+  */
+bool MsgPackMapBase::deserializeReal(int pos, double &value)
+{
+    int64_t tmp;
+    if(*(buffer+pos) == 0xca)
+    {
+        value = deserializeFloat(pos+1);
+        return true;
+    }
+    if(*(buffer+pos) == 0xcb)
+    {
+        value = deserializeDouble(pos+1);
+        return true;
+    }
+    if(deserializeInteger(pos,tmp))
+    {
+        value = *(buffer+pos) == 0xcf ? (double)(uint64_t)tmp : (double)tmp;
+        return true;
+    }
+    return false;
+}
+
+/**
+  *  @brief Indica si el entero deserializado en pos se puede representar con el tipo
+  *         de miembro indicado.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @param value       Entero deserializado (ver deserializeInteger()).
+  *  @param type        Tipo del miembro (MSGPACK_FIELD_*).
+  *  @return bool       True si el entero cabe en el tipo, false en caso contrario.
+  */
+bool MsgPackMapBase::integerFits(int pos, int64_t value, uint8_t type)
+{
+    // Un uint 64 mayor a 2^63-1 se deserializa como un nmero negativo
+    bool big = *(buffer+pos) == 0xcf && value < 0;
+    switch(type)
+    {
+        case MSGPACK_FIELD_UINT8:
+            return !big && value >= 0 && value <= 0xff;
+        case MSGPACK_FIELD_UINT16:
+            return !big && value >= 0 && value <= 0xffff;
+        case MSGPACK_FIELD_UINT32:
+            return !big && value >= 0 && value <= 0xffffffff;
+        case MSGPACK_FIELD_UINT64:
+            return big || value >= 0;
+        case MSGPACK_FIELD_INT8:
+            return !big && value >= -128 && value <= 127;
+        case MSGPACK_FIELD_INT16:
+            return !big && value >= -32768 && value <= 32767;
+        case MSGPACK_FIELD_INT32:
+            return !big && value >= -2147483647-1 && value <= 2147483647;
+        case MSGPACK_FIELD_INT64:
+            return !big;
+    }
+    return false;
+}
+
+/**
+  *  @brief Deserializa un valor en el miembro de una estructura. Los enteros se aceptan
+  *         en cualquier formato siempre que el valor quepa en el tipo del miembro, y los
+  *         nmeros de punto flotante aceptan tambin enteros.
+  *  @param pos         Posicin inicial del stream de datos.
+  *  @param data        Direccin de memoria de la estructura.
+  *  @param field       Descriptor del miembro.
+  *  @return bool       True si el valor es compatible con el miembro, false en caso contrario.
+  */
+bool MsgPackMapBase::deserializeField(int pos, byte data[], const MsgPackField &field)
+{
+    byte *member = data + field.offset;
+    int64_t tmp;
+    double real;
+    uint16_t ini, dataSize;
+    switch(field.type)
+    {
+        case MSGPACK_FIELD_UINT8:
+        case MSGPACK_FIELD_INT8:
+            if(!deserializeInteger(pos,tmp) || !integerFits(pos,tmp,field.type))
+                return false;
+            *member = tmp;
+            return true;
+        case MSGPACK_FIELD_UINT16:
+        case MSGPACK_FIELD_INT16:
+        {
+            if(!deserializeInteger(pos,tmp) || !integerFits(pos,tmp,field.type))
+                return false;
+            uint16_t num = tmp;
+            memcpy(member,&num,sizeof(num));
+            return true;
+        }
+        case MSGPACK_FIELD_UINT32:
+        case MSGPACK_FIELD_INT32:
+        {
+            if(!deserializeInteger(pos,tmp) || !integerFits(pos,tmp,field.type))
+                return false;
+            uint32_t num = tmp;
+            memcpy(member,&num,sizeof(num));
+            return true;
+        }
+        case MSGPACK_FIELD_UINT64:
+        case MSGPACK_FIELD_INT64:
+            if(!deserializeInteger(pos,tmp) || !integerFits(pos,tmp,field.type))
+                return false;
+            memcpy(member,&tmp,sizeof(tmp));
+            return true;
+        case MSGPACK_FIELD_FLOAT:
+        {
+            if(!deserializeReal(pos,real))
+                return false;
+            float num = real;
+            memcpy(member,&num,sizeof(num));
+            return true;
+        }
+        case MSGPACK_FIELD_DOUBLE:
+            if(!deserializeReal(pos,real))
+                return false;
+            memcpy(member,&real,sizeof(real));
+            return true;
+        case MSGPACK_FIELD_BOOL:
+            if(*(buffer+pos) != 0xc2 && *(buffer+pos) != 0xc3)
+                return false;
+            *member = *(buffer+pos) == 0xc3;
+            return true;
+        case MSGPACK_FIELD_STRING:
+            if(field.size == 0 || !getStringData(pos,ini,dataSize))
+                return false;
+            if(dataSize > field.size-1)
+                dataSize = field.size-1;
+            memcpy(member,buffer+ini,dataSize);
+            *(member+dataSize) = '\0';
+            return true;
+    }
+    return false;
+}
+
+/**
+  *  @brief Deserializa un arreglo de enteros comprimido (ver serializeDeltaArray()).
+  *  @param pos         Posicin inicial del stream de datos, -1 si la clave no existe.
+  *  @param buf         Buffer donde se almacenan los elementos.
+  *  @param bufSize     Nmero de elementos del buffer.
+  *  @param type        Tipo esperado de los elementos (MSGPACK_FIELD_*).
+  *  @param size        Tamao de cada elemento en bytes.
+  *  @return uint16_t   Nmero de elementos copiados, 0 si el valor no es un arreglo
+  *                     comprimido del tipo esperado. Si los datos estn truncados se
+  *                     devuelven los elementos completos.
+  */
+uint16_t MsgPackMapBase::deserializeDeltaArray(int pos, byte buf[], uint16_t bufSize, uint8_t type, uint8_t size)
+{
+    uint32_t payload, children;
+    if(pos == -1 || skipElement(pos) == -1)
+        return 0;
+    byte tag = *(buffer+pos);
+    if(tag != 0xc7 && tag != 0xc8 && tag != 0xc9 && (tag < 0xd4 || tag > 0xd8))
+        return 0;
+    uint8_t hdr = headerSize(tag);
+    elementSize(buffer+pos,payload,children);
+    if(*(buffer+pos+hdr-1) != MSGPACK_EXT_DELTA_ARRAY || payload < 1 || *(buffer+pos+hdr) != type)
+        return 0;
+    uint32_t i = pos + hdr + 1;
+    uint32_t end = pos + hdr + payload;
+    uint16_t count = 0;
+    int64_t value = 0;
+    while(i < end && count < bufSize)
+    {
+        uint64_t zigzag = 0;
+        uint8_t shift = 0;
+        byte data;
+        do
+        {
+            if(i >= end || shift > 63)
+                return count;
+            data = *(buffer+(i++));
+            zigzag |= (uint64_t)(data & 0x7f) << shift;
+            shift = shift + 7;
+        }
+        while(data & 0x80);
+        uint64_t delta = (zigzag >> 1) ^ (uint64_t)(-(int64_t)(zigzag & 1));
+        value = (int64_t)((uint64_t)value + delta);
+        storeInteger(buf+((uint32_t)count*size),type,value);
+        count++;
+    }
+    return count;
+}
+
+/**
+  *  @brief Deserializa una serie de nmeros de punto flotante comprimida (ver
+  *         serializeFloatSeries()).
+  *  @param pos         Posicin inicial del stream de datos, -1 si la clave no existe.
+  *  @param buf         Buffer donde se almacenan los valores.
+  *  @param bufSize     Nmero de elementos del buffer.
+  *  @return uint16_t   Nmero de valores copiados, 0 si el valor no es una serie
+  *                     comprimida. Si los datos estn truncados se devuelven los valores
+  *                     completos.
+  */
+uint16_t MsgPackMapBase::deserializeFloatSeries(int pos, float buf[], uint16_t bufSize)
+{
+    uint32_t payload, children;
+    if(pos == -1 || skipElement(pos) == -1)
+        return 0;
+    byte tag = *(buffer+pos);
+    if(tag != 0xc7 && tag != 0xc8 && tag != 0xc9 && (tag < 0xd4 || tag > 0xd8))
+        return 0;
+    uint8_t hdr = headerSize(tag);
+    elementSize(buffer+pos,payload,children);
+    if(*(buffer+pos+hdr-1) != MSGPACK_EXT_FLOAT_SERIES || payload < 2)
+        return 0;
+    uint16_t dataSize = (*(buffer+pos+hdr) << 8) | *(buffer+pos+hdr+1);
+    const byte *bits = buffer+pos+hdr+2;
+    uint32_t bitEnd = (payload - 2)*8;
+    uint32_t bitPos = 0;
+    uint32_t value = 0;
+    uint8_t leading = 0;
+    uint8_t meaningful = 0;
+    uint16_t count = 0;
+    while(count < dataSize && count < bufSize)
+    {
+        if(count == 0)
+        {
+            if(!readBits(bits,bitPos,bitEnd,32,value))
+                break;
+        }
+        else
+        {
+            uint32_t control, diff;
+            if(!readBits(bits,bitPos,bitEnd,1,control))
+                break;
+            if(control == 1)
+            {
+                if(!readBits(bits,bitPos,bitEnd,1,control))
+                    break;
+                if(control == 1)
+                {
+                    uint32_t tmp;
+                    if(!readBits(bits,bitPos,bitEnd,5,tmp))
+                        break;
+                    leading = tmp;
+                    if(!readBits(bits,bitPos,bitEnd,5,tmp))
+                        break;
+                    meaningful = tmp + 1;
+                    if(leading + meaningful > 32)
+                        break;
+                }
+                else if(meaningful == 0)
+                    break;
+                if(!readBits(bits,bitPos,bitEnd,meaningful,diff))
+                    break;
+                value = value ^ (diff << (32 - leading - meaningful));
+            }
+        }
+        memcpy(&buf[count],&value,sizeof(value));
+        count++;
+    }
+    return count;
+}
+
+/**
+  *  @brief Lee bits de un flujo de bits, del ms significativo al menos significativo
+  *         (ver writeBits()).
+  *  @param bits        Direccin del flujo de bits.
+  *  @param bitPos      Posicin del siguiente bit, se incrementa en count.
+  *  @param bitEnd      Nmero de bits del flujo.
+  *  @param count       Nmero de bits (hasta 32).
+  *  @param value       Valor ledo.
+  *  @return bool       True si se ley el valor, false si el flujo no tiene count bits.
+  */
+bool MsgPackMapBase::readBits(const byte bits[], uint32_t &bitPos, uint32_t bitEnd, uint8_t count, uint32_t &value)
+{
+    if(count > bitEnd - bitPos || bitPos > bitEnd)
+        return false;
+    value = 0;
+    while(count > 0)
+    {
+        uint8_t offset = bitPos & 7;
+        uint8_t n = 8 - offset < count ? 8 - offset : count;
+        byte chunk = (bits[bitPos >> 3] >> (8 - offset - n)) & (0xff >> (8 - n));
+        value = (value << n) | chunk;
+        bitPos = bitPos + n;
+        count = count - n;
+    }
+    return true;
+}
+
+/**
+  *  @brief Deserializa un arreglo numrico tipado (ver serializeTypedArray()).
+  *  @param pos         Posicin inicial del stream de datos, -1 si la clave no existe.
+  *  @param buf         Buffer donde se almacenan los elementos.
+  *  @param bufSize     Nmero de elementos del buffer.
+  *  @param type        Tipo esperado de los elementos (MSGPACK_FIELD_*).
+  *  @param size        Tamao de cada elemento en bytes.
+  *  @return uint16_t   Nmero de elementos copiados, 0 si el valor no es un arreglo tipado
+  *                     del tipo esperado.
+  */
+uint16_t MsgPackMapBase::deserializeTypedArray(int pos, void *buf, uint16_t bufSize, uint8_t type, uint8_t size)
+{
+    uint32_t payload, children;
+    if(pos == -1 || skipElement(pos) == -1)
+        return 0;
+    byte tag = *(buffer+pos);
+    if(tag != 0xc7 && tag != 0xc8 && tag != 0xc9 && (tag < 0xd4 || tag > 0xd8))
+        return 0;
+    uint8_t hdr = headerSize(tag);
+    elementSize(buffer+pos,payload,children);
+    if(*(buffer+pos+hdr-1) != MSGPACK_EXT_TYPED_ARRAY || payload < 1 || *(buffer+pos+hdr) != type)
+        return 0;
+    uint32_t count = (payload-1)/size;
+    if(count > bufSize)
+        count = bufSize;
+    swapBytes((byte*)buf,buffer+pos+hdr+1,count,size);
+    return count;
+}
+
+/*********************************************************************
+  *
+  *  Mtodos para agregar elementos al buffer y a la estructura del Map.
+  *  Los elementos se componen de par clave-valor.
+  *  La clave (key) debe ser forzozamente un elemento de tipo cadena.
+  *
+  ********************************************************************/
+
+/**
+  *  @brief Inicializa la estructura del mapa.
+  *  @return none
+  */
+void MsgPackMapBase::beginMap()
+{
+    beginMap(0);
+}
+
+/**
+  *  @brief Inicializa la estructura del mapa reservando la cabecera para el nmero de
+  *         elementos esperado. Si se esperan ms de 15 elementos la cabecera se escribe
+  *         desde el inicio con el formato map 16, de manera que agregar elementos no
+  *         requiere desplazar el contenido del buffer (ver rearrageBuffer()).
+  *  @param numElements Nmero de elementos que se espera agregar al mapa.
+  *  @return none
+  */
+void MsgPackMapBase::beginMap(uint16_t numElements)
+{
+    buffer = mapBuffer;
+    attached = false;
+    this->numElements = 0;
+    startPos = 0;
+    bufferPos = 0;
+    level = 0;
+    clearIndex();
+    error = bufferSize < 3;
+    if(!error)
+        reserveHeader(numElements,false);
+}
+
+/**
+  *  @brief Finaliza la estructura del mapa. Si se utiliza el modo de cabeceras reservadas
+  *         (ver setReserveHeaders()) las cabeceras map 16 de los mapas con 15 elementos o
+  *         menos se reducen a fix map en un solo recorrido del buffer.
+  *  @return none
+  */
+void MsgPackMapBase::endMap()
+{
+    if(reserveHeaders)
+        compactHeaders();
+}
+
+/**
+  *  @brief Activa o desactiva el modo de cabeceras reservadas. En este modo todos los
+  *         mapas y submapas se inician con una cabecera map 16, por lo que agregar
+  *         elementos nunca desplaza el contenido del buffer. Las cabeceras se compactan
+  *         una sola vez al invocar endMap().
+  *  @param reserve     True para activar el modo, false para desactivarlo.
+  *  @return none
+  */
+void MsgPackMapBase::setReserveHeaders(bool reserve)
+{
+    reserveHeaders = reserve;
+}
+
+/**
+  *  @brief Decreta el inicio de un submapa. Un elemento del mapa puede tener
+  *         como valor un submapa. La cantidad mxima de submapas anidados
+  *         (submapas dentro de un mismo submapa) o niveles se define por el
+  *         arreglo de niveles del objeto (MAX_SUBMAPS en MsgPackMap, N en
+  *         MsgPackMapT<N>). Si se excede se activa el indicador de error (ver hasError()).
+  *  @param key         Cadena que representa la clave asociada al submapa.
+  *  @return none
+  */
+void MsgPackMapBase::beginSubMap(const MsgPackKey &key)
+{
+    beginSubMap(key,0);
+}
+
+/**
+  *  @brief Decreta el inicio de un submapa reservando la cabecera para el nmero de
+  *         elementos esperado (ver beginMap(uint16_t)).
+  *  @param key         Cadena que representa la clave asociada al submapa.
+  *  @param numElements Nmero de elementos que se espera agregar al submapa.
+  *  @return none
+  */
+void MsgPackMapBase::beginSubMap(const MsgPackKey &key, uint16_t numElements)
+{
+    beginContainer(&key,numElements,false);
+}
+
+/**
+  *  @brief Decreta el inicio de un submapa sin clave como elemento de un arreglo (ver
+  *         beginArray()), por ejemplo para enviar un arreglo de registros.
+  *  @return none
+  */
+void MsgPackMapBase::beginSubMap()
+{
+    beginContainer(NULL,0,false);
+}
+
+/**
+  *  @brief Decreta el fin de un submapa. Es imperativo llamar a la funcin para indicar
+  *         que los siguientes elementos que se agreguen no pertenecen al submapa
+  *  @return none
+  */
+void MsgPackMapBase::endSubMap()
+{
+    endContainer(false);
+}
+
+/**
+  *  @brief Decreta el inicio de un arreglo. Los elementos del arreglo se agregan con los
+  *         mtodos add* sin clave (por ejemplo addInteger(data)) y pueden ser de tipos
+  *         distintos, submapas (beginSubMap()) u otros arreglos (beginArray()). El
+  *         arreglo ocupa un nivel igual que un submapa.
+  *  @param key         Cadena que representa la clave asociada al arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::beginArray(const MsgPackKey &key)
+{
+    beginArray(key,0);
+}
+
+/**
+  *  @brief Decreta el inicio de un arreglo reservando la cabecera para el nmero de
+  *         elementos esperado (ver beginMap(uint16_t)).
+  *  @param key         Cadena que representa la clave asociada al arreglo.
+  *  @param numElements Nmero de elementos que se espera agregar al arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::beginArray(const MsgPackKey &key, uint16_t numElements)
+{
+    beginContainer(&key,numElements,true);
+}
+
+/**
+  *  @brief Decreta el inicio de un arreglo sin clave como elemento de otro arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::beginArray()
+{
+    beginContainer(NULL,0,true);
+}
+
+/**
+  *  @brief Decreta el fin de un arreglo. Es imperativo llamar a la funcin para indicar
+  *         que los siguientes elementos que se agreguen no pertenecen al arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::endArray()
+{
+    endContainer(true);
+}
+
+/**
+  *  @brief Agrega un submapa o un arreglo vaco y lo convierte en el contenedor actual,
+  *         de manera que los elementos siguientes se agregan a l.
+  *  @param key         Clave del contenedor, NULL si se agrega a un arreglo.
+  *  @param numElements Nmero de elementos que se espera agregar al contenedor.
+  *  @param array       True para un arreglo, false para un submapa.
+  *  @return none
+  */
+void MsgPackMapBase::beginContainer(const MsgPackKey *key, uint16_t numElements, bool array)
+{
+    uint16_t tmp;
+    if(level >= maxDepth)
+    {
+        // El contenedor se descarta pero se cuenta el nivel para que endContainer() sea simtrico
+        error = true;
+        if(level < 255)
+            level++;
+        return;
+    }
+    if(key != NULL ? beginElement(*key,3) : beginElement(false,3))
+    {
+        if(key != NULL)
+            serializeKey(*key);
+        tmp = bufferPos;
+        reserveHeader(numElements,array);
+        endElement();
+    }
+    else
+    {
+        tmp = startPos; // Los elementos del contenedor se descartan (ver hasError())
+    }
+    frames[level].startPos = startPos;
+    frames[level].numElements = this->numElements;
+    startPos = tmp;
+    this->numElements = 0;
+    level++;
+}
+
+/**
+  *  @brief Cierra el contenedor actual y restablece el contenedor anterior. Si el
+  *         contenedor actual no es del tipo indicado se activa el indicador de error.
+  *  @param array       True para cerrar un arreglo, false para cerrar un submapa.
+  *  @return none
+  */
+void MsgPackMapBase::endContainer(bool array)
+{
+    if(level == 0)
+        return;
+    if(!error && isArrayHeader(*(buffer+startPos)) != array)
+        error = true;
+    level--;
+    if(level >= maxDepth)
+        return;
+    startPos = frames[level].startPos;
+    numElements = frames[level].numElements;
+}
+
+/**
+  *  @brief Indica si un byte es la cabecera de un arreglo escrito por el codificador
+  *         (fix array o array 16).
+  *  @param tag         Primer byte del elemento.
+  *  @return bool       True si es la cabecera de un arreglo, false en caso contrario.
+  */
+bool MsgPackMapBase::isArrayHeader(byte tag)
+{
+    return (tag & 0xf0) == 0x90 || tag == 0xdc;
+}
+
+/**
+  *  @brief Escribe en la posicin actual la cabecera de un mapa o arreglo vaco. Si se
+  *         esperan ms de 15 elementos o est activo el modo de cabeceras reservadas se
+  *         escribe una cabecera map 16 (array 16), en caso contrario una cabecera fix map
+  *         (fix array).
+  *  @param numElements Nmero de elementos que se espera agregar al mapa.
+  *  @param array       True para un arreglo, false para un mapa.
+  *  @return none
+  */
+void MsgPackMapBase::reserveHeader(uint16_t numElements, bool array)
+{
+    if(reserveHeaders || numElements > 15)
+    {
+        *(buffer+(bufferPos++)) = array ? 0xdc : 0xde;
+        *(buffer+(bufferPos++)) = 0x00;
+        *(buffer+(bufferPos++)) = 0x00;
+    }
+    else
+    {
+        *(buffer+(bufferPos++)) = array ? 0x90 : 0x80;
+    }
+}
+
+/**
+  *  @brief Prepara el mapa actual para agregar un elemento (ver beginElement(bool, uint32_t)).
+  *  @param key         Clave del elemento.
+  *  @param maxSize     Tamao mximo en bytes del valor serializado.
+  *  @return bool       True si el elemento cabe en el buffer, false en caso contrario.
+  */
+bool MsgPackMapBase::beginElement(const MsgPackKey &key, uint32_t maxSize)
+{
+    return beginElement(true,keyHeaderSize(key) + key.length + maxSize);
+}
+
+/**
+  *  @brief Prepara el mapa o arreglo actual para agregar un elemento. Verifica una sola
+  *         vez que el elemento quepa en el buffer con el tamao mximo que puede ocupar,
+  *         de manera que la serializacin posterior escribe sin comprobaciones. Si el
+  *         contenedor tiene cabecera fix map (fix array) y ya contiene 15 elementos, la
+  *         cabecera se convierte a map 16 (array 16). Si el elemento no cabe, si ya ocurri
+  *         un error, o si se agrega un elemento con clave a un arreglo o sin clave a un
+  *         mapa, no se modifica el buffer y se activa el indicador de error (ver hasError()).
+  *  @param keyed       True si el elemento tiene clave (mapa), false si no (arreglo).
+  *  @param maxSize     Tamao mximo en bytes del elemento serializado (clave incluida).
+  *  @return bool       True si el elemento cabe en el buffer, false en caso contrario.
+  */
+bool MsgPackMapBase::beginElement(bool keyed, uint32_t maxSize)
+{
+    if(attached)
+        error = true;
+    if(error)
+        return false;
+    bool array = isArrayHeader(*(buffer+startPos));
+    bool grow = numElements == 15 && (*(buffer+startPos) & 0xe0) == 0x80;
+    uint32_t required = (uint32_t)bufferPos + maxSize + (grow ? 2 : 0);
+    if(keyed == array || required > bufferSize)
+    {
+        error = true;
+        return false;
+    }
+    if(grow)
+    {
+        rearrageBuffer();
+        *(buffer+startPos) = array ? 0xdc : 0xde;
+        bufferPos = bufferPos + 2;
+    }
+    return true;
+}
+
+/**
+  *  @brief Actualiza la cabecera del mapa o arreglo actual despus de agregar un elemento.
+  *  @return none
+  */
+void MsgPackMapBase::endElement()
+{
+    numElements++;
+    byte tag = *(buffer+startPos);
+    if(tag == 0xde || tag == 0xdc)
+    {
+        *(buffer+(startPos + 1)) = numElements >> 8;
+        *(buffer+(startPos + 2)) = numElements & 0xff;
+    }
+    else
+    {
+        *(buffer+startPos) = ((tag & 0xf0) == 0x90 ? 0x90 : 0x80) | numElements;
+    }
+}
+
+/**
+  *  @brief Reduce a fix map (fix array) las cabeceras map 16 (array 16) de los mapas y
+  *         arreglos con 15 elementos o menos. El buffer se recorre una sola vez desplazando cada elemento a su posicin final.
+  *  @return none
+  */
+void MsgPackMapBase::compactHeaders()
+{
+    uint32_t payload, children;
+    uint16_t src = 0;
+    uint16_t dst = 0;
+    uint16_t len;
+    while(src < bufferPos)
+    {
+        byte tag = *(buffer+src);
+        if((tag == 0xde || tag == 0xdc) && *(buffer+(src + 1)) == 0x00 && *(buffer+(src + 2)) <= 15)
+        {
+            *(buffer+(dst++)) = (tag == 0xde ? 0x80 : 0x90) | *(buffer+(src + 2));
+            src = src + 3;
+        }
+        else
+        {
+            elementSize(buffer+src,payload,children);
+            len = headerSize(tag) + payload;
+            memmove(buffer+dst,buffer+src,len);
+            src = src + len;
+            dst = dst + len;
+        }
+    }
+    bufferPos = dst;
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Entero sin signo de 8 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(const MsgPackKey &key,uint8_t data)
+{
+    if(!beginElement(key,2))
+        return;
+    serializeKey(key);
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Entero sin signo de 16 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(const MsgPackKey &key,uint16_t data)
+{
+    if(!beginElement(key,3))
+        return;
+    serializeKey(key);
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Entero sin signo de 32 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(const MsgPackKey &key,uint32_t data)
+{
+    if(!beginElement(key,5))
+        return;
+    serializeKey(key);
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Entero con signo de 8 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(const MsgPackKey &key,int8_t data)
+{
+    if(!beginElement(key,2))
+        return;
+    serializeKey(key);
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Entero con signo de 16 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(const MsgPackKey &key,int16_t data)
+{
+    if(!beginElement(key,3))
+        return;
+    serializeKey(key);
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Entero con signo de 32 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(const MsgPackKey &key,int32_t data)
+{
+    if(!beginElement(key,5))
+        return;
+    serializeKey(key);
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
+  *         Se utiliza el formato ms pequeo que representa el valor. Si la funcin
+  *         se invoca inmediatamente despus de iniciarse un submap, el elemento se
+  *         agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Entero sin signo de 64 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(const MsgPackKey &key,uint64_t data)
+{
+    if(!beginElement(key,9))
+        return;
+    serializeKey(key);
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de tipo entero.
+  *         Se utiliza el formato ms pequeo que representa el valor. Si la funcin
+  *         se invoca inmediatamente despus de iniciarse un submap, el elemento se
+  *         agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Entero con signo de 64 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(const MsgPackKey &key,int64_t data)
+{
+    if(!beginElement(key,9))
+        return;
+    serializeKey(key);
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de un nmero
+  *         de punto flotante de 4 bytes. Si la funcin se invoca inmediatamente
+  *         despus de iniciarse un submap, el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Nmero de punto flotante (4 bytes).
+  *  @return none
+  */
+void MsgPackMapBase::addFloat(const MsgPackKey &key,float data)
+{
+    if(!beginElement(key,5))
+        return;
+    serializeKey(key);
+    serializeFloat(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de un nmero
+  *         de punto flotante de 8 bytes. Si el valor se puede representar sin
+  *         prdida con 4 bytes se utiliza el formato float 32. Si la funcin se
+  *         invoca inmediatamente despus de iniciarse un submap, el elemento se
+  *         agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Nmero de punto flotante (8 bytes).
+  *  @return none
+  */
+void MsgPackMapBase::addDouble(const MsgPackKey &key,double data)
+{
+    if(!beginElement(key,9))
+        return;
+    serializeKey(key);
+    serializeDouble(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es otra cadena de caracteres.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Cadena de caracteres de tamao mximo 256.
+  *  @return none
+  */
+void MsgPackMapBase::addString(const MsgPackKey &key,const char data[])
+{
+    uint16_t dataSize = strlen(data);
+    if(!beginElement(key,3 + (uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeString(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es de tipo bool.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. True o False (bool).
+  *  @return none
+  */
+void MsgPackMapBase::addBool(const MsgPackKey &key,bool data)
+{
+    if(!beginElement(key,1))
+        return;
+    serializeKey(key);
+    serializeBool(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es null.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @return none
+  */
+void MsgPackMapBase::addNull(const MsgPackKey &key)
+{
+    if(!beginElement(key,1))
+        return;
+    serializeKey(key);
+    serializeNil();
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es un arreglo de bytes.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Arreglo de bytes.
+  *  @param dataSize    Tamao del arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::addByte(const MsgPackKey &key,byte data[],uint16_t dataSize)
+{
+    if(!beginElement(key,3 + (uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeByte(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es un arreglo de tipo float.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Arreglo de tipo float.
+  *  @param dataSize    Tamao del arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::addFloatArray(const MsgPackKey &key,float data[],uint16_t dataSize)
+{
+    if(!beginElement(key,3 + 5*(uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeFloatArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Arreglo de enteros de 8 bits sin signo.
+  *  @param dataSize    Tamao del arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(const MsgPackKey &key,uint8_t data[],uint16_t dataSize)
+{
+    if(!beginElement(key,3 + 2*(uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Arreglo de enteros de 16 bits sin signo.
+  *  @param dataSize    Tamao del arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(const MsgPackKey &key,uint16_t data[],uint16_t dataSize)
+{
+    if(!beginElement(key,3 + 3*(uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Arreglo de enteros de 32 bits sin signo.
+  *  @param dataSize    Tamao del arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(const MsgPackKey &key,uint32_t data[],uint16_t dataSize)
+{
+    if(!beginElement(key,3 + 5*(uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Arreglo de enteros de 8 bits con signo.
+  *  @param dataSize    Tamao del arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(const MsgPackKey &key,int8_t data[],uint16_t dataSize)
+{
+    if(!beginElement(key,3 + 2*(uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Arreglo de enteros de 16 bits con signo.
+  *  @param dataSize    Tamao del arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(const MsgPackKey &key,int16_t data[],uint16_t dataSize)
+{
+    if(!beginElement(key,3 + 3*(uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
+  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
+  *         el elemento se agrega a dicho submap.
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Arreglo de enteros de 32 bits con signo.
+  *  @param dataSize    Tamao del arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(const MsgPackKey &key,int32_t data[],uint16_t dataSize)
+{
+    if(!beginElement(key,3 + 5*(uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
+  *         consta de una cadena de caracteres y el valor asociado es una serie de nmeros
+  *         de punto flotante comprimida (ver serializeFloatSeries()). Conviene en lugar de
+  *         addFloatArray() para seales que cambian poco entre muestras (temperatura,
+  *         presin); el receptor la lee con readFloatSeries().
+  *  @param key         Clave. Cadena de caracteres de tamao mximo 256.
+  *  @param data        Valor. Arreglo de tipo float.
+  *  @param dataSize    Tamao del arreglo.
+  *  @return none
+  */
+void MsgPackMapBase::addFloatSeries(const MsgPackKey &key,const float data[],uint16_t dataSize)
+{
+    if(!beginElement(key,12 + 6*(uint32_t)dataSize))
+        return;
+    serializeKey(key);
+    serializeFloatSeries(data,dataSize);
+    endElement();
+}
+
+/*********************************************************************
+  *
+  *  Mtodos para extraer elementos de la estructura del Map. Los mtodos
+  *  buscan la clave (key) en la estructura y si existe devuelve el .
+  *  contenido.
+  *
+  ********************************************************************/
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo uint8
+  *         lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return uint8_t    Dato deserializado (value).
+  */
+uint8_t MsgPackMapBase::readUnsignedInt8(const MsgPackKey &key)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if(*(buffer+pos) <= 0x7f) //fixInt
+        {
+            return deserializeUnsignedInt8(pos);
+        }
+        else if(*(buffer+pos) == 0xcc) //uint8
+        {
+            return deserializeUnsignedInt8(pos+1);
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo uint16
+  *         lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return uint8_t    Dato deserializado (value).
+  */
+uint16_t MsgPackMapBase::readUnsignedInt16(const MsgPackKey &key)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if(*(buffer+pos) == 0xcd) //uint16
+        {
+            return deserializeUnsignedInt16(pos+1);
+        }
+    }
+    return 0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo uint32
+  *         lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return uint8_t    Dato deserializado (value).
+  */
+uint32_t MsgPackMapBase::readUnsignedInt32(const MsgPackKey &key)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if(*(buffer+pos) == 0xce) //uint16
+        {
+            return deserializeUnsignedInt32(pos+1);
+        }
+    }
+    return 0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo int8
+  *         lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return uint8_t    Dato deserializado (value).
+  */
+int8_t MsgPackMapBase::readInt8(const MsgPackKey &key)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if(*(buffer+pos) >= 0xe0) //fixInt
+        {
+            return deserializeInt8(pos);
+        }
+        else if(*(buffer+pos) == 0xd0) //uint8
+        {
+            return deserializeInt8(pos+1);
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo int16
+  *         lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return uint8_t    Dato deserializado (value).
+  */
+int16_t MsgPackMapBase::readInt16(const MsgPackKey &key)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if(*(buffer+pos) == 0xd1) //uint16
+        {
+            return deserializeInt16(pos+1);
+        }
+    }
+    return 0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo int32
+  *         lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return uint8_t    Dato deserializado (value).
+  */
+int32_t MsgPackMapBase::readInt32(const MsgPackKey &key)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if(*(buffer+pos) == 0xd2) //uint16
+        {
+            return deserializeInt32(pos+1);
+        }
+    }
+    return 0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un entero de cualquier
+  *         formato lo devuelve como uint64, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return uint64_t   Dato deserializado (value).
+  */
+uint64_t MsgPackMapBase::readUnsignedInt64(const MsgPackKey &key)
+{
+    int64_t tmp;
+    int pos = getDataPosition(key);
+    if(pos != -1 && deserializeInteger(pos,tmp))
+        return (uint64_t)tmp;
+    return 0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un entero de cualquier
+  *         formato lo devuelve como int64, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return int64_t    Dato deserializado (value).
+  */
+int64_t MsgPackMapBase::readInt64(const MsgPackKey &key)
+{
+    int64_t tmp;
+    int pos = getDataPosition(key);
+    if(pos != -1 && deserializeInteger(pos,tmp))
+        return tmp;
+    return 0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo float
+  *         lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return uint8_t    Dato deserializado (value).
+  */
+float MsgPackMapBase::readFloat(const MsgPackKey &key)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if(*(buffer+pos) == 0xca) //uint16
+        {
+            return deserializeFloat(pos+1);
+        }
+    }
+    return 0.0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo float 64,
+  *         float 32 o entero lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @return double     Dato deserializado (value).
+  */
+double MsgPackMapBase::readDouble(const MsgPackKey &key)
+{
+    double tmp;
+    int pos = getDataPosition(key);
+    if(pos != -1 && deserializeReal(pos,tmp))
+        return tmp;
+    return 0.0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo bool
+  *         lo devuelve, en caso de no serlo, devuelve 0 (false).
+  *  @param key         Miembro a buscar(key).
+  *  @return uint8_t    Dato deserializado (value).
+  */
+bool MsgPackMapBase::readBool(const MsgPackKey &key)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if(*(buffer+pos) == 0xc3)  //bool
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo String
+  *         lo devuelve, en caso de no serlo, devuelve una cadena vaca.
+  *  @param key         Miembro a buscar(key).
+  *  @return String     Dato deserializado (value).
+  */
+String MsgPackMapBase::readString(const MsgPackKey &key)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+        return deserializeString(pos);
+    return "";
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo cadena lo
+  *         copia en el buffer indicado sin utilizar memoria dinmica. La cadena
+  *         se trunca si no cabe en el buffer y siempre termina en '\0'.
+  *  @param key         Miembro a buscar(key).
+  *  @param buf         Buffer donde se almacena la cadena.
+  *  @param bufSize     Tamao del buffer (incluyendo el caracter nulo).
+  *  @return uint16_t   Nmero de caracteres copiados, 0 si no existe el miembro
+  *                     o no es de tipo cadena.
+  */
+uint16_t MsgPackMapBase::readString(const MsgPackKey &key, char buf[], uint16_t bufSize)
+{
+    uint16_t dataSize, ini;
+    int pos = getDataPosition(key);
+    if(bufSize == 0)
+        return 0;
+    buf[0] = '\0';
+    if(pos != -1 && getStringData(pos,ini,dataSize))
+    {
+        if(dataSize > bufSize-1)
+            dataSize = bufSize-1;
+        memcpy(buf,buffer+ini,dataSize);
+        buf[dataSize] = '\0';
+        return dataSize;
+    }
+    return 0;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un dato de tipo cadena
+  *         devuelve un apuntador a sus caracteres dentro del buffer de la
+  *         estructura, sin copiarlos. La cadena no termina en '\0' y el
+  *         apuntador es vlido mientras no se modifique el buffer.
+  *  @param key         Miembro a buscar(key).
+  *  @param data        Apuntador al primer caracter de la cadena.
+  *  @param dataSize    Nmero de caracteres de la cadena.
+  *  @return bool       Regresa true si se completo la operacin, false
+  *                     si no existe el miembro o no es de tipo cadena.
+  */
+bool MsgPackMapBase::readStringRef(const MsgPackKey &key, const char *&data, uint16_t &dataSize)
+{
+    uint16_t ini;
+    int pos = getDataPosition(key);
+    if(pos != -1 && getStringData(pos,ini,dataSize))
+    {
+        data = (const char*)(buffer+ini);
+        return true;
+    }
+    return false;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un conjunto de  bytes
+  *         lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @param buf         Buffer donde se almacenan los datos.
+  *  @param bufSize     Tamao del buffer.
+  *  @return bool       Regresa true si se completo la operacin, false
+  *                     si no existe el miembro.
+  */
+bool MsgPackMapBase::readByte(const MsgPackKey &key, byte buf[], uint16_t bufSize)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if(*(buffer+pos) >= 0xc4 && *(buffer+pos) <= 0xc6) //bin 8, 16, 32
+        {
+            deserializeByte(pos,buf,bufSize);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es un arreglo de float
+  *         lo devuelve, en caso de no serlo, devuelve 0.
+  *  @param key         Miembro a buscar(key).
+  *  @param buf         Buffer donde se almacenan los datos.
+  *  @param bufSize     Tamao del buffer.
+  *  @return bool       Regresa true si se completo la operacin, false
+  *                     si no existe el miembro.
+  */
+bool MsgPackMapBase::readFloatArray(const MsgPackKey &key, float buf[], uint16_t bufSize)
+{
+    int pos = getDataPosition(key);
+    if(pos != -1)
+    {
+        if((*(buffer+pos) & 0xf0) == 0x90 || *(buffer+pos) == 0xdc || *(buffer+pos) == 0xdd)
+        {
+            deserializeFloatArray(pos,buf,bufSize);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+  *  @brief Busca si la estructura contiene al miembro indicado en key.
+  *         En caso de existir, si el contenido es una serie comprimida (ver
+  *         addFloatSeries()) copia sus valores en buf.
+  *  @param key         Miembro a buscar(key).
+  *  @param buf         Buffer donde se almacenan los datos.
+  *  @param bufSize     Tamao del buffer.
+  *  @return uint16_t   Nmero de valores copiados, 0 si no existe el miembro o no es una
+  *                     serie comprimida.
+  */
+uint16_t MsgPackMapBase::readFloatSeries(const MsgPackKey &key, float buf[], uint16_t bufSize)
+{
+    return deserializeFloatSeries(getDataPosition(key),buf,bufSize);
+}
+
+/*********************************************************************
+  *
+  *  Mtodos para serializar estructuras. Cada miembro se describe con
+  *  MSGPACK_FIELD (clave, tipo y posicin calculados en compilacin) y la
+  *  estructura completa se agrega o se extrae con una sola llamada.
+  *
+  ********************************************************************/
+
+/**
+  *  @brief Agrega al map un elemento por cada miembro descrito en fields. La clave de
+  *         cada elemento ya se encuentra serializada en el descriptor, por lo que no se
+  *         calcula su tamao ni su cabecera. Si la funcin se invoca inmediatamente despus
+  *         de iniciarse un submap, los elementos se agregan a dicho submap.
+  *  @param data        Direccin de memoria de la estructura.
+  *  @param fields      Arreglo de descriptores (ver MSGPACK_FIELD).
+  *  @param numFields   Nmero de descriptores.
+  *  @return none
+  */
+void MsgPackMapBase::addStruct(const void *data, const MsgPackField fields[], uint8_t numFields)
+{
+    for(uint8_t i=0;i<numFields;i++)
+    {
+        if(!beginElement(fields[i].key,3 + (uint32_t)fields[i].size))
+            return;
+        serializeKey(fields[i].key);
+        serializeField((const byte*)data,fields[i]);
+        endElement();
+    }
+}
+
+/**
+  *  @brief Extrae los miembros descritos en fields del mapa principal en un solo recorrido.
+  *         Por cada elemento del mapa se busca el descriptor con la misma clave, iniciando
+  *         por el siguiente al ltimo encontrado, de manera que si los elementos se
+  *         recibieron en el mismo orden de los descriptores cada clave se compara una vez.
+  *         Los miembros sin elemento correspondiente no se modifican.
+  *  @param data        Direccin de memoria de la estructura.
+  *  @param fields      Arreglo de descriptores (ver MSGPACK_FIELD).
+  *  @param numFields   Nmero de descriptores.
+  *  @return uint8_t    Nmero de miembros extrados.
+  */
+uint8_t MsgPackMapBase::readStruct(void *data, const MsgPackField fields[], uint8_t numFields)
+{
+    uint32_t payload, children;
+    uint16_t ini, keySize;
+    uint8_t count = 0;
+    uint8_t next = 0;
+    if(numFields == 0 || getDataEnd() == 0)
+        return 0;
+    byte tag = *(buffer);
+    if(((tag & 0xf0) != 0x80 && tag != 0xde && tag != 0xdf) || headerSize(tag) > getDataEnd())
+        return 0;
+    elementSize(buffer,payload,children);
+    int pos = headerSize(tag);
+    for(uint32_t i=0;i<children;i+=2)
+    {
+        int valuePos = skipElement(pos);
+        int end = skipElement(valuePos);
+        if(end == -1)
+            break;
+        bool isStr = getStringData(pos,ini,keySize);
+        const MsgPackKey *entry = isStr ? NULL : dictionaryKey(pos);
+        if(isStr || entry != NULL)
+        {
+            for(uint8_t j=0, k=next;j<numFields;j++, k=(k+1 < numFields) ? k+1 : 0)
+            {
+                if(isStr ? (fields[k].key.length == keySize && isEqual(ini,fields[k].key)) :
+                   (fields[k].key.length == entry->length && keyHash(fields[k].key) == keyHash(*entry) &&
+                    memcmp(fields[k].key.str,entry->str,entry->length) == 0))
+                {
+                    if(deserializeField(valuePos,(byte*)data,fields[k]))
+                        count++;
+                    next = (k+1 < numFields) ? k+1 : 0;
+                    break;
+                }
+            }
+        }
+        pos = end;
+    }
+    return count;
+}
+
+/**
+  *  @brief Deserializa en data el valor que inicia en pos (ver read() y readPath()).
+  *  @param pos         Posicin de los datos, -1 si la clave o la ruta no existe.
+  *  @param field       Descriptor del valor (tipo y tamao).
+  *  @param data        Direccin de memoria donde se almacena el valor.
+  *  @return uint8_t    MSGPACK_OK, MSGPACK_NOT_FOUND si la clave no existe o
+  *                     MSGPACK_TYPE_MISMATCH si el valor no se puede representar con el tipo.
+  */
+uint8_t MsgPackMapBase::readField(int pos, const MsgPackField &field, void *data)
+{
+    if(pos == -1)
+        return MSGPACK_NOT_FOUND;
+    if(!deserializeField(pos,(byte*)data,field))
+        return MSGPACK_TYPE_MISMATCH;
+    return MSGPACK_OK;
+}
+
+/*********************************************************************
+  *
+  *  Mtodos sin clave para agregar elementos a un arreglo (ver
+  *  beginArray()). Tienen el mismo comportamiento que los mtodos con
+  *  clave; si se invocan fuera de un arreglo se activa el indicador de
+  *  error.
+  *
+  ********************************************************************/
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Entero sin signo de 8 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(uint8_t data)
+{
+    if(!beginElement(false,2))
+        return;
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Entero sin signo de 16 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(uint16_t data)
+{
+    if(!beginElement(false,3))
+        return;
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Entero sin signo de 32 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(uint32_t data)
+{
+    if(!beginElement(false,5))
+        return;
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Entero con signo de 8 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(int8_t data)
+{
+    if(!beginElement(false,2))
+        return;
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Entero con signo de 16 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(int16_t data)
+{
+    if(!beginElement(false,3))
+        return;
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Entero con signo de 32 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(int32_t data)
+{
+    if(!beginElement(false,5))
+        return;
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Entero sin signo de 64 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(uint64_t data)
+{
+    if(!beginElement(false,9))
+        return;
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Entero con signo de 64 bits.
+  *  @return none
+  */
+void MsgPackMapBase::addInteger(int64_t data)
+{
+    if(!beginElement(false,9))
+        return;
+    serializeInteger(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Nmero de punto flotante (4 bytes).
+  *  @return none
+  */
+void MsgPackMapBase::addFloat(float data)
+{
+    if(!beginElement(false,5))
+        return;
+    serializeFloat(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Nmero de punto flotante (8 bytes).
+  *  @return none
+  */
+void MsgPackMapBase::addDouble(double data)
+{
+    if(!beginElement(false,9))
+        return;
+    serializeDouble(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor al arreglo actual.
+  *  @param data        Valor. Booleano.
+  *  @return none
+  */
+void MsgPackMapBase::addBool(bool data)
+{
+    if(!beginElement(false,1))
+        return;
+    serializeBool(data);
+    endElement();
+}
+
+/**
+  *  @brief Agrega una cadena de caracteres al arreglo actual.
+  *  @param data        Valor. Cadena de caracteres terminada en '\0'.
+  *  @return none
+  */
+void MsgPackMapBase::addString(const char data[])
+{
+    uint16_t dataSize = strlen(data);
+    if(!beginElement(false,3 + (uint32_t)dataSize))
+        return;
+    serializeString(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un valor nulo (nil) al arreglo actual.
+  *  @return none
+  */
+void MsgPackMapBase::addNull()
+{
+    if(!beginElement(false,1))
+        return;
+    serializeNil();
+    endElement();
+}
+
+/**
+  *  @brief Agrega un arreglo de bytes al arreglo actual.
+  *  @param data        Arreglo de bytes.
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
+  */
+void MsgPackMapBase::addByte(byte data[],uint16_t dataSize)
+{
+    if(!beginElement(false,3 + (uint32_t)dataSize))
+        return;
+    serializeByte(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un arreglo de nmeros de punto flotante al arreglo actual.
+  *  @param data        Arreglo de nmeros de punto flotante (4 bytes).
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
+  */
+void MsgPackMapBase::addFloatArray(float data[],uint16_t dataSize)
+{
+    if(!beginElement(false,3 + 5*(uint32_t)dataSize))
+        return;
+    serializeFloatArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega una serie de nmeros de punto flotante comprimida al arreglo actual
+  *         (ver addFloatSeries()).
+  *  @param data        Arreglo de nmeros de punto flotante (4 bytes).
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
+  */
+void MsgPackMapBase::addFloatSeries(const float data[],uint16_t dataSize)
+{
+    if(!beginElement(false,12 + 6*(uint32_t)dataSize))
+        return;
+    serializeFloatSeries(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un arreglo de enteros al arreglo actual.
+  *  @param data        Arreglo de enteros (uint8_t).
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(uint8_t data[],uint16_t dataSize)
+{
+    if(!beginElement(false,3 + 2*(uint32_t)dataSize))
+        return;
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un arreglo de enteros al arreglo actual.
+  *  @param data        Arreglo de enteros (uint16_t).
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(uint16_t data[],uint16_t dataSize)
+{
+    if(!beginElement(false,3 + 3*(uint32_t)dataSize))
+        return;
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un arreglo de enteros al arreglo actual.
+  *  @param data        Arreglo de enteros (uint32_t).
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(uint32_t data[],uint16_t dataSize)
+{
+    if(!beginElement(false,3 + 5*(uint32_t)dataSize))
+        return;
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un arreglo de enteros al arreglo actual.
+  *  @param data        Arreglo de enteros (int8_t).
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(int8_t data[],uint16_t dataSize)
+{
+    if(!beginElement(false,3 + 2*(uint32_t)dataSize))
+        return;
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un arreglo de enteros al arreglo actual.
+  *  @param data        Arreglo de enteros (int16_t).
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(int16_t data[],uint16_t dataSize)
+{
+    if(!beginElement(false,3 + 3*(uint32_t)dataSize))
+        return;
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/**
+  *  @brief Agrega un arreglo de enteros al arreglo actual.
+  *  @param data        Arreglo de enteros (int32_t).
+  *  @param dataSize    Tamao del arreglo (hasta 65535 elementos).
+  *  @return none
+  */
+void MsgPackMapBase::addIntegerArray(int32_t data[],uint16_t dataSize)
+{
+    if(!beginElement(false,3 + 5*(uint32_t)dataSize))
+        return;
+    serializeIntegerArray(data,dataSize);
+    endElement();
+}
+
+/*********************************************************************
+  *
+  *  Mtodos con la clave como cadena de caracteres. El tamao, la
+  *  cabecera y el hash de la clave se calculan en cada llamada; para
+  *  claves constantes es preferible utilizar MsgPackKey.
+  *
+  ********************************************************************/
+
+/**
+  *  @brief Equivalente a isKeyAvailable() con la clave como cadena de caracteres.
+  */
+bool MsgPackMapBase::isKeyAvailable(const char keyStr[])
+{
+    return isKeyAvailable(MsgPackKey(keyStr,strlen(keyStr)));
+}
+
+/**
+  *  @brief Equivalente a beginSubMap() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::beginSubMap(const char keyStr[])
+{
+    beginSubMap(MsgPackKey(keyStr,strlen(keyStr)));
+}
+
+/**
+  *  @brief Equivalente a beginSubMap() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::beginSubMap(const char keyStr[], uint16_t numElements)
+{
+    beginSubMap(MsgPackKey(keyStr,strlen(keyStr)),numElements);
+}
+
+/**
+  *  @brief Equivalente a beginArray() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::beginArray(const char keyStr[])
+{
+    beginArray(MsgPackKey(keyStr,strlen(keyStr)));
+}
+
+/**
+  *  @brief Equivalente a beginArray() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::beginArray(const char keyStr[], uint16_t numElements)
+{
+    beginArray(MsgPackKey(keyStr,strlen(keyStr)),numElements);
+}
+
+/**
+  *  @brief Equivalente a addInteger() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addInteger(const char keyStr[],uint8_t data)
+{
+    addInteger(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addInteger() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addInteger(const char keyStr[],uint16_t data)
+{
+    addInteger(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addInteger() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addInteger(const char keyStr[],uint32_t data)
+{
+    addInteger(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addInteger() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addInteger(const char keyStr[],int8_t data)
+{
+    addInteger(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addInteger() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addInteger(const char keyStr[],int16_t data)
+{
+    addInteger(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addInteger() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addInteger(const char keyStr[],int32_t data)
+{
+    addInteger(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addInteger() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addInteger(const char keyStr[],uint64_t data)
+{
+    addInteger(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addInteger() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addInteger(const char keyStr[],int64_t data)
+{
+    addInteger(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addFloat() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addFloat(const char keyStr[],float data)
+{
+    addFloat(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addDouble() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addDouble(const char keyStr[],double data)
+{
+    addDouble(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addString() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addString(const char keyStr[],const char data[])
+{
+    addString(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addBool() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addBool(const char keyStr[],bool data)
+{
+    addBool(MsgPackKey(keyStr,strlen(keyStr)),data);
+}
+
+/**
+  *  @brief Equivalente a addNull() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addNull(const char keyStr[])
+{
+    addNull(MsgPackKey(keyStr,strlen(keyStr)));
+}
+
+/**
+  *  @brief Equivalente a addByte() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addByte(const char keyStr[],byte data[],uint16_t dataSize)
+{
+    addByte(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
+}
+
+/**
+  *  @brief Equivalente a addFloatArray() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addFloatArray(const char keyStr[],float data[],uint16_t dataSize)
+{
+    addFloatArray(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
+}
+
+/**
+  *  @brief Equivalente a addFloatSeries() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addFloatSeries(const char keyStr[],const float data[],uint16_t dataSize)
+{
+    addFloatSeries(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
+}
+
+/**
+  *  @brief Equivalente a addIntegerArray() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addIntegerArray(const char keyStr[],uint8_t data[],uint16_t dataSize)
+{
+    addIntegerArray(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
+}
+
+/**
+  *  @brief Equivalente a addIntegerArray() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addIntegerArray(const char keyStr[],uint16_t data[],uint16_t dataSize)
+{
+    addIntegerArray(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
+}
+
+/**
+  *  @brief Equivalente a addIntegerArray() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addIntegerArray(const char keyStr[],uint32_t data[],uint16_t dataSize)
+{
+    addIntegerArray(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
+}
+
+/**
+  *  @brief Equivalente a addIntegerArray() con la clave como cadena de caracteres.
+  */
+void MsgPackMapBase::addIntegerArray(const char keyStr[],int8_t data[],uint16_t dataSize)
+{
+    addIntegerArray(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es un arreglo de tipo float.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Arreglo de tipo float.
-  *  @param dataSize    Tamao del arreglo.
-  *  @return none
+  *  @brief Equivalente a addIntegerArray() con la clave como cadena de caracteres.
   */
-void MsgPackMap::addFloatArray(const char keyStr[],float data[],uint8_t dataSize)
+void MsgPackMapBase::addIntegerArray(const char keyStr[],int16_t data[],uint16_t dataSize)
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeFloatArray(data,dataSize);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeFloatArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
-    {
-        serializeString(keyStr);
-        serializeFloatArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+    addIntegerArray(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Arreglo de enteros de 8 bits sin signo.
-  *  @param dataSize    Tamao del arreglo.
-  *  @return none
+  *  @brief Equivalente a addIntegerArray() con la clave como cadena de caracteres.
   */
-void MsgPackMap::addIntegerArray(const char keyStr[],uint8_t data[],uint8_t dataSize)
+void MsgPackMapBase::addIntegerArray(const char keyStr[],int32_t data[],uint16_t dataSize)
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+    addIntegerArray(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Arreglo de enteros de 16 bits sin signo.
-  *  @param dataSize    Tamao del arreglo.
-  *  @return none
+  *  @brief Equivalente a readUnsignedInt8() con la clave como cadena de caracteres.
   */
-void MsgPackMap::addIntegerArray(const char keyStr[],uint16_t data[],uint8_t dataSize)
+uint8_t MsgPackMapBase::readUnsignedInt8(const char keyStr[])
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+    return readUnsignedInt8(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Arreglo de enteros de 32 bits sin signo.
-  *  @param dataSize    Tamao del arreglo.
-  *  @return none
+  *  @brief Equivalente a readUnsignedInt16() con la clave como cadena de caracteres.
   */
-void MsgPackMap::addIntegerArray(const char keyStr[],uint32_t data[],uint8_t dataSize)
+uint16_t MsgPackMapBase::readUnsignedInt16(const char keyStr[])
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+    return readUnsignedInt16(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Arreglo de enteros de 8 bits con signo.
-  *  @param dataSize    Tamao del arreglo.
-  *  @return none
+  *  @brief Equivalente a readUnsignedInt32() con la clave como cadena de caracteres.
   */
-void MsgPackMap::addIntegerArray(const char keyStr[],int8_t data[],uint8_t dataSize)
+uint32_t MsgPackMapBase::readUnsignedInt32(const char keyStr[])
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+    return readUnsignedInt32(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Arreglo de enteros de 16 bits con signo.
-  *  @param dataSize    Tamao del arreglo.
-  *  @return none
+  *  @brief Equivalente a readInt8() con la clave como cadena de caracteres.
   */
-void MsgPackMap::addIntegerArray(const char keyStr[],int16_t data[],uint8_t dataSize)
+int8_t MsgPackMapBase::readInt8(const char keyStr[])
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+    return readInt8(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Agrega al map un elemento compuesto de un par clave-valor. La clave
-  *         consta de una cadena de caracteres y el valor asociado es un arreglo de enteros.
-  *         Si la funcin se invoca inmediatamente despus de iniciarse un submap,
-  *         el elemento se agrega a dicho submap.
-  *  @param keyStr      Clave. Cadena de caracteres de tamao mximo 256.
-  *  @param data        Valor. Arreglo de enteros de 32 bits con signo.
-  *  @param dataSize    Tamao del arreglo.
-  *  @return none
+  *  @brief Equivalente a readInt16() con la clave como cadena de caracteres.
   */
-void MsgPackMap::addIntegerArray(const char keyStr[],int32_t data[],uint8_t dataSize)
+int16_t MsgPackMapBase::readInt16(const char keyStr[])
 {
-    if(numElements < 15)
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+startPos) = 0x80 | ++numElements;
-    }
-    else if(numElements == 15)
-    {
-        rearrageBuffer();
-        *(buffer+startPos) = 0xde;
-        *(buffer+(startPos + 1)) = 0x00;
-        bufferPos = bufferPos+2;
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
-    else
-    {
-        serializeString(keyStr);
-        serializeIntegerArray(data,dataSize);
-        *(buffer+(startPos + 2)) = ++numElements;
-    }
+    return readInt16(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
-/*********************************************************************
-  *
-  *  Mtodos para extraer elementos de la estructura del Map. Los mtodos
-  *  buscan la clave (key) en la estructura y si existe devuelve el .
-  *  contenido.
-  *
-  ********************************************************************/
+/**
+  *  @brief Equivalente a readInt32() con la clave como cadena de caracteres.
+  */
+int32_t MsgPackMapBase::readInt32(const char keyStr[])
+{
+    return readInt32(MsgPackKey(keyStr,strlen(keyStr)));
+}
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un dato de tipo uint8
-  *         lo devuelve, en caso de no serlo, devuelve 0.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @return uint8_t    Dato deserializado (value).
+  *  @brief Equivalente a readUnsignedInt64() con la clave como cadena de caracteres.
   */
-uint8_t MsgPackMap::readUnsignedInt8(const char keyStr[])
+uint64_t MsgPackMapBase::readUnsignedInt64(const char keyStr[])
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) >= 0x00 && *(buffer+pos) <= 0x7f) //fixInt
-        {
-            return deserializeUnsignedInt8(pos);
-        }
-        else if(*(buffer+pos) == 0xcc) //uint8
-        {
-            return deserializeUnsignedInt8(pos+1);
-        }
-        else
-        {
-            return 0;
-        }
-    }
-    return 0;
+    return readUnsignedInt64(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un dato de tipo uint16
-  *         lo devuelve, en caso de no serlo, devuelve 0.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @return uint8_t    Dato deserializado (value).
+  *  @brief Equivalente a readInt64() con la clave como cadena de caracteres.
   */
-uint16_t MsgPackMap::readUnsignedInt16(const char keyStr[])
+int64_t MsgPackMapBase::readInt64(const char keyStr[])
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) == 0xcd) //uint16
-        {
-            return deserializeUnsignedInt16(pos+1);
-        }
-    }
-    return 0;
+    return readInt64(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un dato de tipo uint32
-  *         lo devuelve, en caso de no serlo, devuelve 0.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @return uint8_t    Dato deserializado (value).
+  *  @brief Equivalente a readFloat() con la clave como cadena de caracteres.
   */
-uint32_t MsgPackMap::readUnsignedInt32(const char keyStr[])
+float MsgPackMapBase::readFloat(const char keyStr[])
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) == 0xce) //uint16
-        {
-            return deserializeUnsignedInt32(pos+1);
-        }
-    }
-    return 0;
+    return readFloat(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un dato de tipo int8
-  *         lo devuelve, en caso de no serlo, devuelve 0.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @return uint8_t    Dato deserializado (value).
+  *  @brief Equivalente a readDouble() con la clave como cadena de caracteres.
   */
-int8_t MsgPackMap::readInt8(const char keyStr[])
+double MsgPackMapBase::readDouble(const char keyStr[])
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) >= 0xe0 && *(buffer+pos) <= 0xff) //fixInt
-        {
-            return deserializeInt8(pos);
-        }
-        else if(*(buffer+pos) == 0xd0) //uint8
-        {
-            return deserializeInt8(pos+1);
-        }
-        else
-        {
-            return 0;
-        }
-    }
-    return 0;
+    return readDouble(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un dato de tipo int16
-  *         lo devuelve, en caso de no serlo, devuelve 0.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @return uint8_t    Dato deserializado (value).
+  *  @brief Equivalente a readBool() con la clave como cadena de caracteres.
   */
-int16_t MsgPackMap::readInt16(const char keyStr[])
+bool MsgPackMapBase::readBool(const char keyStr[])
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) == 0xd1) //uint16
-        {
-            return deserializeInt16(pos+1);
-        }
-    }
-    return 0;
+    return readBool(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un dato de tipo int32
-  *         lo devuelve, en caso de no serlo, devuelve 0.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @return uint8_t    Dato deserializado (value).
+  *  @brief Equivalente a readString() con la clave como cadena de caracteres.
   */
-int32_t MsgPackMap::readInt32(const char keyStr[])
+String MsgPackMapBase::readString(const char keyStr[])
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) == 0xd2) //uint16
-        {
-            return deserializeInt32(pos+1);
-        }
-    }
-    return 0;
+    return readString(MsgPackKey(keyStr,strlen(keyStr)));
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un dato de tipo float
-  *         lo devuelve, en caso de no serlo, devuelve 0.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @return uint8_t    Dato deserializado (value).
+  *  @brief Equivalente a readString() con la clave como cadena de caracteres.
   */
-float MsgPackMap::readFloat(const char keyStr[])
+uint16_t MsgPackMapBase::readString(const char keyStr[], char buf[], uint16_t bufSize)
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) == 0xca) //uint16
-        {
-            return deserializeFloat(pos+1);
-        }
-    }
-    return 0.0;
+    return readString(MsgPackKey(keyStr,strlen(keyStr)),buf,bufSize);
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un dato de tipo bool
-  *         lo devuelve, en caso de no serlo, devuelve 0 (false).
-  *  @param keyStr      Miembro a buscar(key).
-  *  @return uint8_t    Dato deserializado (value).
+  *  @brief Equivalente a readStringRef() con la clave como cadena de caracteres.
   */
-bool MsgPackMap::readBool(const char keyStr[])
+bool MsgPackMapBase::readStringRef(const char keyStr[], const char *&data, uint16_t &dataSize)
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) == 0xc3)  //bool
-        {
-            return true;
-        }
-    }
-    return false;
+    return readStringRef(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un dato de tipo String
-  *         lo devuelve, en caso de no serlo, devuelve una cadena vaca.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @return uint8_t    Dato deserializado (value).
+  *  @brief Equivalente a readByte() con la clave como cadena de caracteres.
   */
-String MsgPackMap::readString(const char keyStr[])
+bool MsgPackMapBase::readByte(const char keyStr[], byte buf[], uint16_t bufSize)
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) >= 0xa0 && *(buffer+pos) <= 0xbf || *(buffer+pos) == 0xd9) //fixStr o str8
-        {
-            return deserializeString(pos);
-        }
-    }
-    return "";
+    return readByte(MsgPackKey(keyStr,strlen(keyStr)),buf,bufSize);
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un conjunto de  bytes
-  *         lo devuelve, en caso de no serlo, devuelve 0.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @param buf         Buffer donde se almacenan los datos.
-  *  @param bufSize     Tamao del buffer.
-  *  @return bool       Regresa true si se completo la operacin, false
-  *                     si no existe el miembro.
+  *  @brief Equivalente a readFloatArray() con la clave como cadena de caracteres.
   */
-bool MsgPackMap::readByte(const char keyStr[], byte buf[], uint8_t bufSize)
+bool MsgPackMapBase::readFloatArray(const char keyStr[], float buf[], uint16_t bufSize)
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) == 0xc4)
-        {
-            deserializeByte(pos+1,buf,bufSize);
-            return true;
-        }
-    }
-    return false;
+    return readFloatArray(MsgPackKey(keyStr,strlen(keyStr)),buf,bufSize);
 }
 
 /**
-  *  @brief Busca si la estructura contiene al miembro indicado en keyStr.
-  *         En caso de existir, si el contenido es un arreglo de float
-  *         lo devuelve, en caso de no serlo, devuelve 0.
-  *  @param keyStr      Miembro a buscar(key).
-  *  @param buf         Buffer donde se almacenan los datos.
-  *  @param bufSize     Tamao del buffer.
-  *  @return bool       Regresa true si se completo la operacin, false
-  *                     si no existe el miembro.
+  *  @brief Equivalente a readFloatSeries() con la clave como cadena de caracteres.
   */
-bool MsgPackMap::readFloatArray(const char keyStr[], float buf[], uint8_t bufSize)
+uint16_t MsgPackMapBase::readFloatSeries(const char keyStr[], float buf[], uint16_t bufSize)
 {
-    int pos = getDataPosition(keyStr);
-    if(pos != -1)
-    {
-        if(*(buffer+pos) >= 0x90 && *(buffer+pos) <= 0x9f || *(buffer+pos) == 0xdc)
-        {
-            deserializeFloatArray(pos,buf,bufSize);
-            return true;
-        }
-    }
-    return false;
+    return readFloatSeries(MsgPackKey(keyStr,strlen(keyStr)),buf,bufSize);
 }
@@ -3,67 +3,429 @@
 
 #include "Arduino.h"
 
+// Niveles de submapas de MsgPackMap y MsgPackStreamParser. Solo determina el tamano de
+// esos tipos, definidos en los archivos de cabecera; las clases base compiladas en la
+// biblioteca no dependen de este valor. Para otra profundidad se recomienda MsgPackMapT<N>
+#ifndef MAX_SUBMAPS
 #define MAX_SUBMAPS 5
+#endif
+#define WRITE_CHUNK_SIZE 64
 
-class MsgPackMap
+struct MsgPackFrame
+{
+    uint16_t startPos;      // Posicion de la cabecera del mapa que contiene al submapa
+    uint16_t numElements;   // Numero de elementos de dicho mapa
+};
+
+struct MsgPackIndexEntry
+{
+    uint16_t hash;      // Hash de la clave
+    uint16_t keyPos;    // Posicion del primer caracter de la clave
+    uint16_t dataPos;   // Posicion del valor asociado a la clave
+    uint16_t parentPos; // Posicion de la cabecera del mapa que contiene la clave
+};
+
+// Hash (djb2 de 16 bits) de una clave, calculado en compilacion para claves constantes.
+// La cadena se divide a la mitad en cada llamada, por lo que la recursion tiene una
+// profundidad de log2(length) aun si se evalua en ejecucion
+constexpr uint16_t msgPackHash(const char *str, uint16_t length, uint16_t hash = 5381)
+{
+    return length == 0 ? hash : (length == 1 ? (uint16_t)(hash*33 + (byte)*str) :
+           msgPackHash(str+length/2,length-length/2,msgPackHash(str,length/2,hash)));
+}
+
+// Posicion del primer '\0' de str entre first y last (last si no existe), con la misma
+// division a la mitad que msgPackHash()
+constexpr size_t msgPackFindEnd(const char *str, size_t first, size_t last);
+constexpr size_t msgPackFindEndRight(const char *str, size_t left, size_t mid, size_t last)
+{
+    return left < mid ? left : msgPackFindEnd(str,mid,last);
+}
+constexpr size_t msgPackFindEnd(const char *str, size_t first, size_t last)
+{
+    return last - first <= 1 ? (last > first && str[first] == '\0' ? first : last) :
+           msgPackFindEndRight(str,msgPackFindEnd(str,first,first+(last-first)/2),first+(last-first)/2,last);
+}
+
+class MsgPackKey
+{
+    public:
+        // Clave a partir de una cadena literal o de un arreglo constante: longitud (hasta el
+        // primer '\0'), cabecera y hash se calculan en compilacion
+        template<size_t N> constexpr MsgPackKey(const char (&keyStr)[N])
+            : MsgPackKey(keyStr,msgPackFindEnd(keyStr,0,N-1),true) {}
+        // Clave a partir de un arreglo modificable (p. ej. un buffer de recepcion): la
+        // longitud llega hasta el primer '\0' y el hash se calcula solo si se necesita
+        template<size_t N> MsgPackKey(char (&keyStr)[N])
+            : MsgPackKey(keyStr,bufferLength(keyStr,N),false) {}
+        // Clave a partir de una cadena de longitud conocida: el hash se calcula solo si se
+        // necesita (indice, diccionario o esquema), con un ciclo (ver MsgPackMap::keyHash())
+        constexpr MsgPackKey(const char keyStr[], uint16_t keyLength)
+            : MsgPackKey(keyStr,keyLength,false) {}
+
+        const char *str;    // Caracteres de la clave
+        uint16_t length;    // Numero de caracteres
+        byte header;        // Cabecera serializada (fix str, str 8 o str 16)
+        uint16_t hash;      // Hash de la clave si hashed es true (ver MsgPackMap::buildIndex())
+        bool hashed;        // True si el hash se calculo al construir la clave
+
+    private:
+        constexpr MsgPackKey(const char keyStr[], size_t keyLength, bool withHash)
+            : str(keyStr), length(keyLength), header(keyLength < 32 ? 0xa0+keyLength : (keyLength < 256 ? 0xd9 : 0xda)),
+              hash(withHash ? msgPackHash(keyStr,keyLength) : 0), hashed(withHash) {}
+        static size_t bufferLength(const char keyStr[], size_t size)
+        {
+            const char *end = (const char*)memchr(keyStr,'\0',size);
+            return end != NULL ? end - keyStr : size;
+        }
+};
+
+#define MSGPACK_FIELD_UINT8 0
+#define MSGPACK_FIELD_UINT16 1
+#define MSGPACK_FIELD_UINT32 2
+#define MSGPACK_FIELD_INT8 3
+#define MSGPACK_FIELD_INT16 4
+#define MSGPACK_FIELD_INT32 5
+#define MSGPACK_FIELD_FLOAT 6
+#define MSGPACK_FIELD_BOOL 7
+#define MSGPACK_FIELD_STRING 8
+#define MSGPACK_FIELD_UINT64 9
+#define MSGPACK_FIELD_INT64 10
+#define MSGPACK_FIELD_DOUBLE 11
+
+// Tipo de extension de los arreglos tipados (ver addTypedArray()). El primer byte de los datos
+// es el tipo de los elementos (MSGPACK_FIELD_*), seguido de los elementos en big endian
+#ifndef MSGPACK_EXT_TYPED_ARRAY
+#define MSGPACK_EXT_TYPED_ARRAY 1
+#endif
+
+// Tipo de extension de los arreglos de enteros comprimidos (ver addDeltaArray()). El primer
+// byte de los datos es el tipo de los elementos (MSGPACK_FIELD_*), seguido de la diferencia
+// de cada elemento con el anterior en zigzag y LEB128
+#ifndef MSGPACK_EXT_DELTA_ARRAY
+#define MSGPACK_EXT_DELTA_ARRAY 2
+#endif
+
+// Tipo de extension de las series de float comprimidas (ver addFloatSeries())
+#ifndef MSGPACK_EXT_FLOAT_SERIES
+#define MSGPACK_EXT_FLOAT_SERIES 3
+#endif
+
+#define MSGPACK_OK 0
+#define MSGPACK_NOT_FOUND 1
+#define MSGPACK_TYPE_MISMATCH 2
+
+struct MsgPackField
+{
+    MsgPackKey key;     // Clave del elemento
+    uint8_t type;       // Tipo del miembro (MSGPACK_FIELD_*)
+    uint16_t offset;    // Posicion del miembro dentro de la estructura
+    uint16_t size;      // Tamano del miembro en bytes
+};
+
+template<typename T> struct MsgPackFieldType;
+template<> struct MsgPackFieldType<uint8_t> { static const uint8_t value = MSGPACK_FIELD_UINT8; };
+template<> struct MsgPackFieldType<uint16_t> { static const uint8_t value = MSGPACK_FIELD_UINT16; };
+template<> struct MsgPackFieldType<uint32_t> { static const uint8_t value = MSGPACK_FIELD_UINT32; };
+template<> struct MsgPackFieldType<int8_t> { static const uint8_t value = MSGPACK_FIELD_INT8; };
+template<> struct MsgPackFieldType<int16_t> { static const uint8_t value = MSGPACK_FIELD_INT16; };
+template<> struct MsgPackFieldType<int32_t> { static const uint8_t value = MSGPACK_FIELD_INT32; };
+template<> struct MsgPackFieldType<uint64_t> { static const uint8_t value = MSGPACK_FIELD_UINT64; };
+template<> struct MsgPackFieldType<int64_t> { static const uint8_t value = MSGPACK_FIELD_INT64; };
+template<> struct MsgPackFieldType<double> { static const uint8_t value = MSGPACK_FIELD_DOUBLE; };
+template<> struct MsgPackFieldType<float> { static const uint8_t value = MSGPACK_FIELD_FLOAT; };
+template<> struct MsgPackFieldType<bool> { static const uint8_t value = MSGPACK_FIELD_BOOL; };
+template<size_t N> struct MsgPackFieldType<char[N]> { static const uint8_t value = MSGPACK_FIELD_STRING; };
+
+// Descriptor de un miembro de una estructura con clave explicita o con el nombre del miembro
+#define MSGPACK_FIELD_KEY(type, member, keyStr) \
+    { MsgPackKey(keyStr), MsgPackFieldType<decltype(((type*)0)->member)>::value, offsetof(type, member), sizeof(((type*)0)->member) }
+#define MSGPACK_FIELD(type, member) MSGPACK_FIELD_KEY(type, member, #member)
+
+// Estructura msgpack sobre un buffer y un arreglo de niveles proporcionados por el usuario.
+// No incluye almacenamiento propio para los niveles (ver MsgPackMapT y MsgPackMap)
+class MsgPackMapBase
 {
     public:
-        MsgPackMap(byte buf[], uint16_t bufSize);
+        MsgPackMapBase(byte buf[], uint16_t bufSize, MsgPackFrame frames[], uint8_t maxDepth);
         uint16_t getMapSize();
-        uint8_t readNumElements();
+        uint32_t readNumElements();
         void setStream(Stream &serial);
+        void attachData(byte data[], uint16_t length);
         bool isKeyAvailable(const char keyStr[]);
+        bool isKeyAvailable(const MsgPackKey &key);
+        bool isPathAvailable(const char path[]);
+        bool buildIndex(MsgPackIndexEntry idx[], uint8_t idxSize);
+        void clearIndex();
+        void setReadCursor(bool enable);
+        void setKeyDictionary(const MsgPackKey keys[], uint8_t numKeys);
+        // Diccionario a partir de un arreglo de claves (hasta 128)
+        template<size_t N> void setKeyDictionary(const MsgPackKey (&keys)[N])
+        {
+            static_assert(N <= 128,"El diccionario admite hasta 128 claves");
+            setKeyDictionary(keys,N);
+        }
 
         void printRawData();
         void printRawData(int numCol);
-        void writeData();
+        uint16_t writeData();
+        void setWriteChunkSize(uint16_t chunkSize);
+        void beginWriteData();
+        uint16_t continueWriteData();
         void clearData();
+        bool hasError();
 
         void beginMap();
+        void beginMap(uint16_t numElements);
+        void endMap();
+        void setReserveHeaders(bool reserve);
         void beginSubMap(const char keyStr[]);
+        void beginSubMap(const MsgPackKey &key);
+        void beginSubMap(const char keyStr[], uint16_t numElements);
+        void beginSubMap(const MsgPackKey &key, uint16_t numElements);
+        void beginSubMap();
         void endSubMap();
+        void beginArray(const char keyStr[]);
+        void beginArray(const MsgPackKey &key);
+        void beginArray(const char keyStr[], uint16_t numElements);
+        void beginArray(const MsgPackKey &key, uint16_t numElements);
+        void beginArray();
+        void endArray();
 
         void addInteger(const char keyStr[], uint8_t data);
+        void addInteger(const MsgPackKey &key, uint8_t data);
         void addInteger(const char keyStr[], uint16_t data);
+        void addInteger(const MsgPackKey &key, uint16_t data);
         void addInteger(const char keyStr[], uint32_t data);
+        void addInteger(const MsgPackKey &key, uint32_t data);
         void addInteger(const char keyStr[], int8_t data);
+        void addInteger(const MsgPackKey &key, int8_t data);
         void addInteger(const char keyStr[], int16_t data);
+        void addInteger(const MsgPackKey &key, int16_t data);
         void addInteger(const char keyStr[], int32_t data);
+        void addInteger(const MsgPackKey &key, int32_t data);
+        void addInteger(const char keyStr[], uint64_t data);
+        void addInteger(const MsgPackKey &key, uint64_t data);
+        void addInteger(const char keyStr[], int64_t data);
+        void addInteger(const MsgPackKey &key, int64_t data);
         void addFloat(const char keyStr[], float data);
+        void addFloat(const MsgPackKey &key, float data);
+        void addDouble(const char keyStr[], double data);
+        void addDouble(const MsgPackKey &key, double data);
         void addString(const char keyStr[], const char data[]);
+        void addString(const MsgPackKey &key, const char data[]);
         void addBool(const char keyStr[], bool data);
+        void addBool(const MsgPackKey &key, bool data);
         void addNull(const char keyStr[]); //nil
-        void addByte(const char keyStr[], byte data[],uint8_t dataSize);
-        void addFloatArray(const char keyStr[], float data[],uint8_t dataSize);
-        void addIntegerArray(const char keyStr[], uint8_t data[],uint8_t dataSize);
-        void addIntegerArray(const char keyStr[], uint16_t data[],uint8_t dataSize);
-        void addIntegerArray(const char keyStr[], uint32_t data[],uint8_t dataSize);
-        void addIntegerArray(const char keyStr[], int8_t data[],uint8_t dataSize);
-        void addIntegerArray(const char keyStr[], int16_t data[],uint8_t dataSize);
-        void addIntegerArray(const char keyStr[], int32_t data[],uint8_t dataSize);
+        void addNull(const MsgPackKey &key); //nil
+        void addByte(const char keyStr[], byte data[],uint16_t dataSize);
+        void addByte(const MsgPackKey &key, byte data[],uint16_t dataSize);
+        void addFloatArray(const char keyStr[], float data[],uint16_t dataSize);
+        void addFloatArray(const MsgPackKey &key, float data[],uint16_t dataSize);
+        void addFloatSeries(const char keyStr[], const float data[], uint16_t dataSize);
+        void addFloatSeries(const MsgPackKey &key, const float data[], uint16_t dataSize);
+        void addIntegerArray(const char keyStr[], uint8_t data[], uint16_t dataSize);
+        void addIntegerArray(const MsgPackKey &key, uint8_t data[], uint16_t dataSize);
+        void addIntegerArray(const char keyStr[], uint16_t data[],uint16_t dataSize);
+        void addIntegerArray(const MsgPackKey &key, uint16_t data[],uint16_t dataSize);
+        void addIntegerArray(const char keyStr[], uint32_t data[],uint16_t dataSize);
+        void addIntegerArray(const MsgPackKey &key, uint32_t data[],uint16_t dataSize);
+        void addIntegerArray(const char keyStr[], int8_t data[],uint16_t dataSize);
+        void addIntegerArray(const MsgPackKey &key, int8_t data[],uint16_t dataSize);
+        void addIntegerArray(const char keyStr[], int16_t data[],uint16_t dataSize);
+        void addIntegerArray(const MsgPackKey &key, int16_t data[],uint16_t dataSize);
+        void addIntegerArray(const char keyStr[], int32_t data[],uint16_t dataSize);
+        void addIntegerArray(const MsgPackKey &key, int32_t data[],uint16_t dataSize);
+
+        // Elementos sin clave de un arreglo (ver beginArray())
+        void addInteger(uint8_t data);
+        void addInteger(uint16_t data);
+        void addInteger(uint32_t data);
+        void addInteger(int8_t data);
+        void addInteger(int16_t data);
+        void addInteger(int32_t data);
+        void addInteger(uint64_t data);
+        void addInteger(int64_t data);
+        void addFloat(float data);
+        void addDouble(double data);
+        void addString(const char data[]);
+        void addBool(bool data);
+        void addNull();
+        void addByte(byte data[], uint16_t dataSize);
+        void addFloatArray(float data[], uint16_t dataSize);
+        void addFloatSeries(const float data[], uint16_t dataSize);
+        void addIntegerArray(uint8_t data[], uint16_t dataSize);
+        void addIntegerArray(uint16_t data[], uint16_t dataSize);
+        void addIntegerArray(uint32_t data[], uint16_t dataSize);
+        void addIntegerArray(int8_t data[], uint16_t dataSize);
+        void addIntegerArray(int16_t data[], uint16_t dataSize);
+        void addIntegerArray(int32_t data[], uint16_t dataSize);
 
         uint8_t readUnsignedInt8(const char keyStr[]);
+        uint8_t readUnsignedInt8(const MsgPackKey &key);
         uint16_t readUnsignedInt16(const char keyStr[]);
+        uint16_t readUnsignedInt16(const MsgPackKey &key);
         uint32_t readUnsignedInt32(const char keyStr[]);
+        uint32_t readUnsignedInt32(const MsgPackKey &key);
         int8_t readInt8(const char keyStr[]);
+        int8_t readInt8(const MsgPackKey &key);
         int16_t readInt16(const char keyStr[]);
+        int16_t readInt16(const MsgPackKey &key);
         int32_t readInt32(const char keyStr[]);
+        int32_t readInt32(const MsgPackKey &key);
+        uint64_t readUnsignedInt64(const char keyStr[]);
+        uint64_t readUnsignedInt64(const MsgPackKey &key);
+        int64_t readInt64(const char keyStr[]);
+        int64_t readInt64(const MsgPackKey &key);
         float readFloat(const char keyStr[]);
+        float readFloat(const MsgPackKey &key);
+        double readDouble(const char keyStr[]);
+        double readDouble(const MsgPackKey &key);
         String readString(const char keyStr[]);
+        String readString(const MsgPackKey &key);
+        uint16_t readString(const char keyStr[], char buf[], uint16_t bufSize);
+        uint16_t readString(const MsgPackKey &key, char buf[], uint16_t bufSize);
+        bool readStringRef(const char keyStr[], const char *&data, uint16_t &dataSize);
+        bool readStringRef(const MsgPackKey &key, const char *&data, uint16_t &dataSize);
         bool readBool(const char keyStr[]);
-        bool readByte(const char keyStr[], byte buf[], uint8_t bufSize);
-        bool readFloatArray(const char keyStr[], float buf[], uint8_t bufSize);
+        bool readBool(const MsgPackKey &key);
+        bool readByte(const char keyStr[], byte buf[], uint16_t bufSize);
+        bool readByte(const MsgPackKey &key, byte buf[], uint16_t bufSize);
+        bool readFloatArray(const char keyStr[], float buf[], uint16_t bufSize);
+        bool readFloatArray(const MsgPackKey &key, float buf[], uint16_t bufSize);
+        uint16_t readFloatSeries(const char keyStr[], float buf[], uint16_t bufSize);
+        uint16_t readFloatSeries(const MsgPackKey &key, float buf[], uint16_t bufSize);
+
+        void addStruct(const void *data, const MsgPackField fields[], uint8_t numFields);
+        uint8_t readStruct(void *data, const MsgPackField fields[], uint8_t numFields);
+        template<typename T, size_t N> void addStruct(const T &data, const MsgPackField (&fields)[N])
+        {
+            addStruct(&data,fields,N);
+        }
+        template<typename T, size_t N> uint8_t readStruct(T &data, const MsgPackField (&fields)[N])
+        {
+            return readStruct(&data,fields,N);
+        }
+
+        // Lee el valor de la clave en out con una sola busqueda. Acepta cualquier formato de
+        // entero que quepa en T y enteros para float/double. Devuelve MSGPACK_OK,
+        // MSGPACK_NOT_FOUND o MSGPACK_TYPE_MISMATCH; en caso de error out no se modifica.
+        template<typename T> uint8_t read(const MsgPackKey &key, T &out)
+        {
+            MsgPackField field = { key, MsgPackFieldType<T>::value, 0, sizeof(T) };
+            return readField(getDataPosition(key),field,&out);
+        }
+        template<typename T> uint8_t read(const char keyStr[], T &out)
+        {
+            return read(MsgPackKey(keyStr,strlen(keyStr)),out);
+        }
+        // Igual que read() con una ruta de claves separadas por punto ("imu.accel.x"); cada
+        // clave se busca solo dentro del submapa de la anterior
+        template<typename T> uint8_t readPath(const char path[], T &out)
+        {
+            MsgPackField field = { MsgPackKey(""), MsgPackFieldType<T>::value, 0, sizeof(T) };
+            return readField(getPathPosition(path),field,&out);
+        }
+
+        // Arreglo numerico tipado: una sola cabecera ext con el tipo de los elementos, seguida
+        // de los elementos sin etiqueta (ver serializeTypedArray())
+        template<typename T> void addTypedArray(const MsgPackKey &key, const T data[], uint16_t dataSize)
+        {
+            static_assert(MsgPackFieldType<T>::value != MSGPACK_FIELD_STRING,"Tipo no numerico");
+            if(beginElement(key,6 + (uint32_t)dataSize*sizeof(T)))
+            {
+                serializeKey(key);
+                serializeTypedArray(data,dataSize,MsgPackFieldType<T>::value,sizeof(T));
+                endElement();
+            }
+        }
+        template<typename T> void addTypedArray(const char keyStr[], const T data[], uint16_t dataSize)
+        {
+            addTypedArray(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
+        }
+        template<typename T> void addTypedArray(const T data[], uint16_t dataSize)
+        {
+            static_assert(MsgPackFieldType<T>::value != MSGPACK_FIELD_STRING,"Tipo no numerico");
+            if(beginElement(false,6 + (uint32_t)dataSize*sizeof(T)))
+            {
+                serializeTypedArray(data,dataSize,MsgPackFieldType<T>::value,sizeof(T));
+                endElement();
+            }
+        }
+        // Copia en buf los elementos de un arreglo tipado del mismo tipo que T; devuelve el
+        // numero de elementos copiados (0 si la clave no existe o el tipo no coincide)
+        template<typename T> uint16_t readTypedArray(const MsgPackKey &key, T buf[], uint16_t bufSize)
+        {
+            return deserializeTypedArray(getDataPosition(key),buf,bufSize,MsgPackFieldType<T>::value,sizeof(T));
+        }
+        template<typename T> uint16_t readTypedArray(const char keyStr[], T buf[], uint16_t bufSize)
+        {
+            return readTypedArray(MsgPackKey(keyStr,strlen(keyStr)),buf,bufSize);
+        }
+        // Arreglo de enteros comprimido: diferencias entre elementos consecutivos en zigzag y
+        // LEB128, para series que cambian lentamente (ver serializeDeltaArray())
+        template<typename T> void addDeltaArray(const MsgPackKey &key, const T data[], uint16_t dataSize)
+        {
+            static_assert(isIntegerField(MsgPackFieldType<T>::value),"Tipo no entero");
+            if(beginElement(key,7 + (uint32_t)dataSize*maxVarintSize(sizeof(T))))
+            {
+                serializeKey(key);
+                serializeDeltaArray((const byte*)data,dataSize,sizeof(T),MsgPackFieldType<T>::value);
+                endElement();
+            }
+        }
+        template<typename T> void addDeltaArray(const char keyStr[], const T data[], uint16_t dataSize)
+        {
+            addDeltaArray(MsgPackKey(keyStr,strlen(keyStr)),data,dataSize);
+        }
+        template<typename T> void addDeltaArray(const T data[], uint16_t dataSize)
+        {
+            static_assert(isIntegerField(MsgPackFieldType<T>::value),"Tipo no entero");
+            if(beginElement(false,7 + (uint32_t)dataSize*maxVarintSize(sizeof(T))))
+            {
+                serializeDeltaArray((const byte*)data,dataSize,sizeof(T),MsgPackFieldType<T>::value);
+                endElement();
+            }
+        }
+        // Copia en buf los elementos de un arreglo comprimido del mismo tipo que T; devuelve el
+        // numero de elementos copiados (0 si la clave no existe o el tipo no coincide)
+        template<typename T> uint16_t readDeltaArray(const MsgPackKey &key, T buf[], uint16_t bufSize)
+        {
+            return deserializeDeltaArray(getDataPosition(key),(byte*)buf,bufSize,MsgPackFieldType<T>::value,sizeof(T));
+        }
+        template<typename T> uint16_t readDeltaArray(const char keyStr[], T buf[], uint16_t bufSize)
+        {
+            return readDeltaArray(MsgPackKey(keyStr,strlen(keyStr)),buf,bufSize);
+        }
 
     private:
+        friend class MsgPackStreamParserBase;
+        friend class MsgPackIterator;
+        friend class MsgPackBatch;
+
         byte *buffer; // Apuntador a la estructura serializada
+        byte *mapBuffer; // Buffer del objeto (buffer apunta al mensaje de attachData())
         Stream *_serial; // Apuntador a
         uint16_t bufferSize;
-        uint8_t numElements = 0;
+        uint16_t numElements = 0;
         uint16_t startPos = 0;
         uint16_t bufferPos = 0;
+        uint16_t dataSize = 0; // Longitud del mensaje asociado con attachData()
+        bool attached = false;
         uint8_t level = 0;
-        uint16_t positions[MAX_SUBMAPS];
-        uint8_t elements[MAX_SUBMAPS];
+        MsgPackFrame *frames; // Niveles de los submapas abiertos
+        uint8_t maxDepth;
+        MsgPackIndexEntry *index = NULL;
+        uint8_t indexCount = 0;
+        const MsgPackKey *dictionary = NULL; // Claves que se serializan como positive fixint
+        uint8_t dictionarySize = 0;
+        uint16_t writePos = 0;
+        uint16_t writeChunkSize = WRITE_CHUNK_SIZE;
+        bool writeSpaceKnown = false; // El Stream reporta espacio con availableForWrite()
+        bool reserveHeaders = false;
+        bool readCursor = false;
+        uint16_t cursorPos = 0; // Fin del ultimo valor encontrado (ver setReadCursor())
+        bool error = false;
 
         union decimal
         {
@@ -77,19 +439,50 @@ class MsgPackMap
         void serializeInteger(int8_t data);
         void serializeInteger(int16_t data);
         void serializeInteger(int32_t data);
+        void serializeInteger(uint64_t data);
+        void serializeInteger(int64_t data);
         void serializeFloat(float data);
+        void serializeDouble(double data);
         void serializeString(const char data[]);
+        void serializeString(const char data[], uint16_t dataSize);
+        void serializeKey(const MsgPackKey &key);
         void serializeBool(bool data);
-        void serializeByte(byte data[], uint8_t dataSize);
-        void serializeFloatArray(float data[], uint8_t dataSize);
-        void serializeIntegerArray(uint8_t data[], uint8_t dataSize);
-        void serializeIntegerArray(uint16_t data[], uint8_t dataSize);
-        void serializeIntegerArray(uint32_t data[], uint8_t dataSize);
-        void serializeIntegerArray(int8_t data[], uint8_t dataSize);
-        void serializeIntegerArray(int16_t data[], uint8_t dataSize);
-        void serializeIntegerArray(int32_t data[], uint8_t dataSize);
+        void serializeByte(byte data[], uint16_t dataSize);
+        void serializeArrayHeader(uint16_t dataSize);
+        void serializeTypedArray(const void *data, uint16_t dataSize, uint8_t type, uint8_t size);
+        void serializeFloatSeries(const float data[], uint16_t dataSize);
+        static void writeBits(byte bits[], uint32_t &bitPos, uint32_t value, uint8_t count);
+        void endExtPayload(uint16_t start, int8_t extType);
+        void serializeDeltaArray(const byte data[], uint16_t dataSize, uint16_t stride, uint8_t type);
+        static constexpr bool isIntegerField(uint8_t type)
+        {
+            return type <= MSGPACK_FIELD_INT32 || type == MSGPACK_FIELD_UINT64 || type == MSGPACK_FIELD_INT64;
+        }
+        static constexpr uint8_t maxVarintSize(uint8_t size)
+        {
+            return size + size/4 + 1;
+        }
+        static int64_t loadInteger(const byte data[], uint8_t type);
+        static void storeInteger(byte data[], uint8_t type, int64_t value);
+        static void swapBytes(byte * __restrict__ dst, const byte * __restrict__ src, uint32_t dataSize, uint8_t size);
+        void serializeFloatArray(float data[], uint16_t dataSize);
+        void serializeIntegerArray(uint8_t data[], uint16_t dataSize);
+        void serializeIntegerArray(uint16_t data[], uint16_t dataSize);
+        void serializeIntegerArray(uint32_t data[], uint16_t dataSize);
+        void serializeIntegerArray(int8_t data[], uint16_t dataSize);
+        void serializeIntegerArray(int16_t data[], uint16_t dataSize);
+        void serializeIntegerArray(int32_t data[], uint16_t dataSize);
         void serializeNil();
+        void serializeField(const byte data[], const MsgPackField &field);
         bool rearrageBuffer();
+        void reserveHeader(uint16_t numElements, bool array);
+        void beginContainer(const MsgPackKey *key, uint16_t numElements, bool array);
+        void endContainer(bool array);
+        static bool isArrayHeader(byte tag);
+        bool beginElement(const MsgPackKey &key, uint32_t maxSize);
+        bool beginElement(bool keyed, uint32_t maxSize);
+        void endElement();
+        void compactHeaders();
 
         uint8_t deserializeUnsignedInt8(int pos);
         uint16_t deserializeUnsignedInt16(int pos);
@@ -97,13 +490,55 @@ class MsgPackMap
         int8_t deserializeInt8(int pos);
         int16_t deserializeInt16(int pos);
         int32_t deserializeInt32(int pos);
+        uint64_t deserializeUnsignedInt64(int pos);
+        int64_t deserializeInt64(int pos);
+        double deserializeDouble(int pos);
         float deserializeFloat(int pos);
         String deserializeString(int pos);
+        bool getStringData(int pos, uint16_t &ini, uint16_t &dataSize);
         bool deserializeBool(int pos);
-        void deserializeByte(int pos, byte buf[], uint8_t bufSize);
-        void deserializeFloatArray(int pos, float buf[], uint8_t bufSize);
-        bool isEqual(uint8_t pos, const char keyStr[]);
-        int getDataPosition(const char keyStr[]);
+        void deserializeByte(int pos, byte buf[], uint16_t bufSize);
+        void deserializeFloatArray(int pos, float buf[], uint16_t bufSize);
+        bool deserializeInteger(int pos, int64_t &value);
+        bool deserializeReal(int pos, double &value);
+        bool integerFits(int pos, int64_t value, uint8_t type);
+        bool deserializeField(int pos, byte data[], const MsgPackField &field);
+        uint16_t deserializeFloatSeries(int pos, float buf[], uint16_t bufSize);
+        static bool readBits(const byte bits[], uint32_t &bitPos, uint32_t bitEnd, uint8_t count, uint32_t &value);
+        uint16_t deserializeDeltaArray(int pos, byte buf[], uint16_t bufSize, uint8_t type, uint8_t size);
+        uint16_t deserializeTypedArray(int pos, void *buf, uint16_t bufSize, uint8_t type, uint8_t size);
+        uint8_t readField(int pos, const MsgPackField &field, void *data);
+        bool isEqual(uint16_t pos, const MsgPackKey &key);
+        int getDataPosition(const MsgPackKey &key);
+        int scanKey(const MsgPackKey &key, uint16_t from, uint16_t to);
+        static uint8_t keyHeaderSize(const MsgPackKey &key);
+        int getIndexedPosition(const MsgPackKey &key, int parentPos);
+        int findKey(int mapPos, const MsgPackKey &key);
+        int16_t keyId(const MsgPackKey &key);
+        const MsgPackKey *dictionaryKey(int pos);
+        bool matchKey(int pos, const MsgPackKey &key, int16_t id);
+        int searchKey(int &pos, const MsgPackKey &key, int16_t id, uint8_t depth);
+        int getPathPosition(const char path[]);
+
+        static uint8_t headerSize(byte tag);
+        static void elementSize(const byte header[], uint32_t &payload, uint32_t &children);
+        static uint16_t hashKey(const byte data[], uint16_t dataSize);
+        static uint16_t keyHash(const MsgPackKey &key);
+        int skipElement(int pos);
+        uint16_t getDataEnd();
+        int indexElement(int pos, uint16_t parentPos, uint8_t idxSize, uint8_t depth);
 
 };
+
+// Estructura con un arreglo propio de Depth niveles de submapas
+template<uint8_t Depth> class MsgPackMapT : public MsgPackMapBase
+{
+    public:
+        MsgPackMapT(byte buf[], uint16_t bufSize) : MsgPackMapBase(buf,bufSize,levels,Depth) {}
+
+    private:
+        MsgPackFrame levels[Depth];
+};
+
+typedef MsgPackMapT<MAX_SUBMAPS> MsgPackMap;
 #endif // MSGPACK_H
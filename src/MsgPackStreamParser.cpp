@@ -0,0 +1,300 @@
+#include "MsgPackStreamParser.h"
+#include "Arduino.h"
+#include <string.h>
+
+#define STATE_ROOT 0
+#define STATE_KEY 1
+#define STATE_VALUE 2
+#define STATE_ITEMS 3
+
+/**
+  *  @brief Constructor del objeto con un arreglo de niveles proporcionado por el usuario,
+  *         equivalente al de MsgPackMapBase. El arreglo guarda los elementos pendientes del
+  *         mapa principal y de cada submapa abierto, por lo que debe tener maxDepth+1
+  *         elementos para recibir hasta maxDepth submapas anidados. El buffer solo
+  *         almacena el par clave-valor que se est recibiendo, por lo que su tamao debe
+  *         ser suficiente para la clave (dos veces) y el valor ms grande de la
+  *         estructura, no para la estructura completa. La clase base no incluye un arreglo
+  *         de niveles propio; MsgPackStreamParserT<N> (y MsgPackStreamParser, con
+  *         MAX_SUBMAPS niveles) lo agregan.
+  *  @param buf         Direccin de memoria del buffer de datos (arreglo de bytes).
+  *  @param bufSize     Tamao del buffer.
+  *  @param remaining   Arreglo de niveles (debe existir mientras se utilice el objeto).
+  *  @param maxDepth    Nmero mximo de submapas anidados (hasta 255).
+  *  @return none
+  */
+MsgPackStreamParserBase::MsgPackStreamParserBase(byte buf[], uint16_t bufSize, uint32_t remaining[], uint8_t maxDepth)
+{
+    buffer = buf;
+    bufferSize = bufSize;
+    this->remaining = remaining;
+    this->maxDepth = maxDepth;
+    reset();
+}
+
+/**
+  *  @brief Asigna el objeto de tipo Stream del cual se leen los datos. Esta funcin se
+  *         debe llamar antes de utilizar parse().
+  *  @param serial      Direccin de memoria del objeto Stream (monitor serial, etc.).
+  *  @return none
+  */
+void MsgPackStreamParserBase::setStream(Stream &serial)
+{
+    _serial = &serial;
+}
+
+/**
+  *  @brief Asigna la funcin que recibe los eventos generados durante la decodificacin.
+  *         Por cada par clave-valor se genera un evento MSGPACK_EVENT_VALUE cuyo campo
+  *         pair es un mapa de un solo elemento, por lo que el valor se obtiene con los
+  *         mtodos read* de MsgPackMap. Los submapas generan los eventos
+  *         MSGPACK_EVENT_BEGIN_MAP y MSGPACK_EVENT_END_MAP, y el fin de la estructura el
+  *         evento MSGPACK_EVENT_END.
+  *  @param handler     Funcin que recibe los eventos.
+  *  @return none
+  */
+void MsgPackStreamParserBase::setHandler(MsgPackEventHandler handler)
+{
+    _handler = handler;
+}
+
+/**
+  *  @brief Asigna el diccionario de claves del emisor (ver MsgPackMap::setKeyDictionary()).
+  *         Las claves recibidas como ndice se entregan en los eventos como la cadena del
+  *         diccionario.
+  *  @param keys        Arreglo de claves, NULL para desactivar el diccionario.
+  *  @param numKeys     Nmero de claves (se consideran hasta 128).
+  *  @return none
+  */
+void MsgPackStreamParserBase::setKeyDictionary(const MsgPackKey keys[], uint8_t numKeys)
+{
+    dictionary = keys;
+    dictionarySize = keys != NULL ? (numKeys < 128 ? numKeys : 128) : 0;
+}
+
+/**
+  *  @brief Descarta la estructura en proceso y el estado de error. La siguiente
+  *         llamada a parse() espera el inicio de una nueva estructura.
+  *  @return none
+  */
+void MsgPackStreamParserBase::reset()
+{
+    bufferPos = 0;
+    tokenStart = 0;
+    tokenLeft = 0;
+    inHeader = false;
+    pending = 0;
+    state = STATE_ROOT;
+    level = 0;
+    error = false;
+}
+
+/**
+  *  @brief Indica si se recibi una estructura no vlida o un elemento que no cabe en
+  *         el buffer. En ese caso se debe llamar a reset() antes de continuar.
+  *  @return bool       True si ocurri un error, false en caso contrario.
+  */
+bool MsgPackStreamParserBase::hasError()
+{
+    return error;
+}
+
+/**
+  *  @brief Lee los bytes disponibles en el objeto Stream y genera los eventos de los
+  *         elementos que se completan. El estado se conserva entre llamadas, por lo que
+  *         la funcin se puede invocar desde loop() conforme llegan los datos. La
+  *         lectura se detiene al completar una estructura; los bytes siguientes se
+  *         procesan en la prxima llamada.
+  *  @return bool       True si se complet una estructura, false en caso contrario.
+  */
+bool MsgPackStreamParserBase::parse()
+{
+    int data;
+    while(!error && _serial->available() > 0)
+    {
+        data = _serial->read();
+        if(data < 0)
+            break;
+        if(feed((byte)data) && tokenComplete())
+            return true;
+    }
+    return false;
+}
+
+/**
+  *  @brief Agrega un byte al buffer y actualiza el estado del elemento (token) en proceso.
+  *         Un token se compone de la cabecera de un elemento y sus datos; el contenido de
+  *         arreglos y mapas se procesa como tokens independientes.
+  *  @param data        Byte recibido.
+  *  @return bool       True si el byte completa un token, false en caso contrario.
+  */
+bool MsgPackStreamParserBase::feed(byte data)
+{
+    uint32_t payload, children;
+    if(bufferPos >= bufferSize)
+    {
+        error = true;
+        return false;
+    }
+    *(buffer+(bufferPos++)) = data;
+    if(tokenLeft == 0)
+    {
+        tokenStart = bufferPos-1;
+        tokenLeft = MsgPackMapBase::headerSize(data);
+        if(tokenLeft == 0)
+        {
+            error = true;
+            return false;
+        }
+        inHeader = true;
+    }
+    tokenLeft--;
+    if(tokenLeft == 0 && inHeader)
+    {
+        inHeader = false;
+        MsgPackMapBase::elementSize(buffer+tokenStart,payload,children);
+        // Los elementos de los mapas de la estructura no se almacenan juntos; los de los
+        // arreglos (y mapas dentro de arreglos) ocupan al menos un byte cada uno
+        byte tag = *(buffer+tokenStart);
+        bool isMap = (tag & 0xf0) == 0x80 || tag == 0xde || tag == 0xdf;
+        bool staged = state == STATE_ITEMS || (state == STATE_VALUE && !isMap);
+        if(payload > (uint32_t)(bufferSize-bufferPos) || (staged && children > (uint32_t)(bufferSize-bufferPos)))
+        {
+            error = true;
+            return false;
+        }
+        tokenLeft = payload;
+    }
+    return tokenLeft == 0;
+}
+
+/**
+  *  @brief Procesa un token completo de acuerdo al estado actual: cabecera del mapa
+  *         principal, clave o (parte de un) valor.
+  *  @return bool       True si el token completa la estructura, false en caso contrario.
+  */
+bool MsgPackStreamParserBase::tokenComplete()
+{
+    uint32_t payload, children;
+    byte tag = *(buffer+tokenStart);
+    bool isMap = (tag & 0xf0) == 0x80 || tag == 0xde || tag == 0xdf;
+    MsgPackMapBase::elementSize(buffer+tokenStart,payload,children);
+    if(state == STATE_ROOT)
+    {
+        if(!isMap)
+        {
+            error = true;
+            return false;
+        }
+        remaining[level++] = children/2;
+        return closeEntries();
+    }
+    if(state == STATE_KEY)
+    {
+        if((tag & 0xe0) != 0xa0 && (tag < 0xd9 || tag > 0xdb) && tag >= dictionarySize)
+        {
+            error = true;
+            return false;
+        }
+        state = STATE_VALUE;
+        pending = 1;
+        return false;
+    }
+    // La clave se almacena a partir de la posicin 1, antes del valor
+    uint32_t keySize;
+    uint32_t items = children;
+    const byte *keyChars;
+    if(*(buffer+1) < dictionarySize)
+    {
+        keyChars = (const byte*)dictionary[*(buffer+1)].str;
+        keySize = dictionary[*(buffer+1)].length;
+    }
+    else
+    {
+        keyChars = buffer + 1 + MsgPackMapBase::headerSize(*(buffer+1));
+        MsgPackMapBase::elementSize(buffer+1,keySize,children);
+    }
+    if(isMap && state == STATE_VALUE)
+    {
+        // Submapa: la clave terminada en '\0' sustituye a la cabecera
+        if(level > maxDepth || tokenStart + keySize + 1 > bufferSize)
+        {
+            error = true;
+            return false;
+        }
+        memcpy(buffer+tokenStart,keyChars,keySize);
+        *(buffer+(tokenStart + keySize)) = '\0';
+        emit(MSGPACK_EVENT_BEGIN_MAP,level-1,(const char*)(buffer+tokenStart),NULL);
+        remaining[level++] = items/2;
+        return closeEntries();
+    }
+    // Arreglos y dems valores se almacenan completos
+    state = STATE_ITEMS;
+    pending = pending - 1 + items;
+    if(pending > 0)
+        return false;
+    // Valor completo: la clave terminada en '\0' se copia a continuacin del valor
+    if(bufferPos + keySize + 1 > bufferSize)
+    {
+        error = true;
+        return false;
+    }
+    uint16_t valueEnd = bufferPos;
+    memcpy(buffer+valueEnd,keyChars,keySize);
+    *(buffer+(valueEnd + keySize)) = '\0';
+    MsgPackMap pair(buffer,valueEnd);
+    pair.setKeyDictionary(dictionary,dictionarySize);
+    emit(MSGPACK_EVENT_VALUE,level-1,(const char*)(buffer+valueEnd),&pair);
+    remaining[level-1]--;
+    return closeEntries();
+}
+
+/**
+  *  @brief Cierra los mapas cuyos elementos ya se recibieron por completo y prepara el
+  *         estado para la siguiente clave o para una nueva estructura.
+  *  @return bool       True si se complet la estructura, false en caso contrario.
+  */
+bool MsgPackStreamParserBase::closeEntries()
+{
+    while(level > 0 && remaining[level-1] == 0)
+    {
+        level--;
+        if(level > 0)
+        {
+            emit(MSGPACK_EVENT_END_MAP,level-1,"",NULL);
+            remaining[level-1]--;
+        }
+    }
+    if(level == 0)
+    {
+        emit(MSGPACK_EVENT_END,0,"",NULL);
+        state = STATE_ROOT;
+        bufferPos = 0;
+        return true;
+    }
+    // El par clave-valor en proceso se almacena como un mapa de un elemento
+    *(buffer) = 0x81;
+    bufferPos = 1;
+    state = STATE_KEY;
+    return false;
+}
+
+/**
+  *  @brief Enva un evento a la funcin asignada con setHandler().
+  *  @param type        Tipo de evento (MSGPACK_EVENT_*).
+  *  @param depth       Nivel del mapa al que pertenece la clave.
+  *  @param key         Clave terminada en '\0'.
+  *  @param pair        Mapa con el par clave-valor, NULL si el evento no tiene valor.
+  *  @return none
+  */
+void MsgPackStreamParserBase::emit(uint8_t type, uint8_t depth, const char key[], MsgPackMapBase *pair)
+{
+    MsgPackEvent event;
+    if(_handler == NULL)
+        return;
+    event.type = type;
+    event.depth = depth;
+    event.key = key;
+    event.pair = pair;
+    _handler(event);
+}
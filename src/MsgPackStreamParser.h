@@ -0,0 +1,70 @@
+#ifndef MsgPackStreamParser_h
+#define MsgPackStreamParser_h
+
+#include "Arduino.h"
+#include "MsgPackMap.h"
+
+#define MSGPACK_EVENT_VALUE 0
+#define MSGPACK_EVENT_BEGIN_MAP 1
+#define MSGPACK_EVENT_END_MAP 2
+#define MSGPACK_EVENT_END 3
+
+struct MsgPackEvent
+{
+    uint8_t type;       // Tipo de evento (MSGPACK_EVENT_*)
+    uint8_t depth;      // Nivel del mapa al que pertenece la clave (0 = mapa principal)
+    const char *key;    // Clave terminada en '\0' (vacia en END_MAP y END)
+    MsgPackMapBase *pair; // Mapa con el par clave-valor (solo en VALUE)
+};
+
+typedef void (*MsgPackEventHandler)(const MsgPackEvent &event);
+
+// Decodificador incremental con un arreglo de niveles proporcionado por el usuario. No
+// incluye almacenamiento propio para los niveles (ver MsgPackStreamParserT)
+class MsgPackStreamParserBase
+{
+    public:
+        MsgPackStreamParserBase(byte buf[], uint16_t bufSize, uint32_t remaining[], uint8_t maxDepth);
+        void setStream(Stream &serial);
+        void setHandler(MsgPackEventHandler handler);
+        void setKeyDictionary(const MsgPackKey keys[], uint8_t numKeys);
+        void reset();
+        bool parse();
+        bool hasError();
+
+    private:
+        byte *buffer; // Buffer para el par clave-valor en proceso
+        Stream *_serial;
+        MsgPackEventHandler _handler = NULL;
+        const MsgPackKey *dictionary = NULL;
+        uint8_t dictionarySize = 0;
+        uint16_t bufferSize;
+        uint16_t bufferPos = 0;
+        uint16_t tokenStart = 0;
+        uint32_t tokenLeft = 0;
+        bool inHeader = false;
+        uint32_t pending = 0;
+        uint8_t state = 0;
+        uint16_t level = 0;
+        uint32_t *remaining; // Elementos pendientes del mapa principal y de cada submapa abierto
+        uint8_t maxDepth;
+        bool error = false;
+
+        bool feed(byte data);
+        bool tokenComplete();
+        bool closeEntries();
+        void emit(uint8_t type, uint8_t depth, const char key[], MsgPackMapBase *pair);
+};
+
+// Decodificador con un arreglo propio para Depth niveles de submapas
+template<uint8_t Depth> class MsgPackStreamParserT : public MsgPackStreamParserBase
+{
+    public:
+        MsgPackStreamParserT(byte buf[], uint16_t bufSize) : MsgPackStreamParserBase(buf,bufSize,levels,Depth) {}
+
+    private:
+        uint32_t levels[Depth+1];
+};
+
+typedef MsgPackStreamParserT<MAX_SUBMAPS> MsgPackStreamParser;
+#endif // MsgPackStreamParser_h